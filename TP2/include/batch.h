@@ -0,0 +1,33 @@
+/**
+ * @file batch.h
+ * @brief Ejecucion en paralelo de un archivo de comandos (`-j N`).
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+/**
+ * @brief  Bytes que se copian por vez de la salida capturada de un comando.
+ */
+#define BATCH_COPY_SIZE 65536
+
+/**
+ * @brief Ejecuta las lineas de un archivo con hasta `max_jobs` a la vez.
+ *
+ * Cada linea corre en una copia de la shell (un `cd` no afecta a las demas),
+ * con stdin en /dev/null y stdout y stderr capturados en un archivo en memoria.
+ * Apenas hay lugar se lanza la linea siguiente; los hijos se recogen a medida
+ * que terminan. La salida de cada linea se escribe entera y en el orden del
+ * archivo, sin mezclarse con las otras. Al final se muestra por stderr un
+ * resumen con el estado y el tiempo de cada linea. Las lineas vacias y los
+ * comentarios se saltean. Si no se puede esperar a un hijo, su linea y las que
+ * no se llegaron a lanzar cuentan como fallidas, con estado 126.
+ *
+ * @param filename Archivo de comandos, una linea por comando.
+ * @param max_jobs Maximo de lineas corriendo a la vez (al menos 1).
+ * @return int Cantidad de lineas que terminaron con un estado distinto de 0, o
+ * -1 si no se pudo leer el archivo.
+ */
+int executeBatchParallel(const char* filename, int max_jobs);
+
+#endif // BATCH_H
@@ -0,0 +1,79 @@
+/**
+ * @file builtins.h
+ * @brief Tabla de comandos internos de la shell.
+ *
+ * Cada comando interno se registra con su nombre y la funcion que lo corre. La
+ * tabla esta ordenada por un hash perfecto (al estilo de gperf) calculado para
+ * estos nombres: buscar un comando es calcular el hash y hacer un solo strcmp.
+ * Un comando interno corre dentro de la shell, con sus redirecciones aplicadas
+ * a stdin, stdout y stderr mientras dura, o en un hijo creado con fork cuando es
+ * una etapa de un pipeline o va en segundo plano.
+ */
+
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include "jobs.h"
+
+/**
+ * @brief  Cantidad de lugares de la tabla (el hash mas alto + 1).
+ */
+#define BUILTIN_SLOTS 24
+
+/**
+ * @brief  Largo del nombre de comando interno mas corto ("cd").
+ */
+#define BUILTIN_MIN_LENGTH 2
+
+/**
+ * @brief  Largo del nombre de comando interno mas largo ("status_monitor").
+ */
+#define BUILTIN_MAX_LENGTH 14
+
+/**
+ * @struct s_builtin
+ * @brief Comando interno registrado.
+ */
+typedef struct s_builtin
+{
+    const char* name;
+    int (*run)(char* args[]); /**< Recibe el comando y sus argumentos; devuelve su estado. */
+} t_builtin;
+
+/**
+ * @brief Busca un comando interno por nombre.
+ *
+ * @param name Nombre del comando.
+ * @return const t_builtin* El comando, o NULL si no es interno.
+ */
+const t_builtin* findBuiltin(const char* name);
+
+/**
+ * @brief Corre un comando interno dentro de la shell.
+ *
+ * Los descriptores de opts pasan a ser stdin, stdout y stderr mientras corre el
+ * comando; despues se restauran los de la shell. El grupo se ignora.
+ *
+ * @param builtin Comando a correr.
+ * @param args Comando y argumentos, terminados en `NULL`.
+ * @param opts Redirecciones, o NULL para usar las de la shell.
+ * @return int Estado del comando.
+ */
+int runBuiltin(const t_builtin* builtin, char* args[], const t_launch* opts);
+
+/**
+ * @brief Corre un comando interno en un hijo, como si fuera un programa.
+ *
+ * El hijo se crea con fork (tiene que tener una copia de la shell para correr
+ * el comando), pasa al grupo pedido, vuelve las señales a su accion por
+ * defecto, aplica las redirecciones y sale con el estado del comando. Lo que el
+ * comando cambie en la shell (directorio, tabla de trabajos) queda en el hijo.
+ *
+ * @param builtin Comando a correr.
+ * @param args Comando y argumentos, terminados en `NULL`.
+ * @param opts Redirecciones y grupo, como en launchProgram.
+ * @return pid_t PID del hijo, o -1 con errno si no se pudo crear.
+ */
+pid_t launchBuiltin(const t_builtin* builtin, char* args[], const t_launch* opts);
+
+#endif // BUILTINS_H
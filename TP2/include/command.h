@@ -1,6 +1,6 @@
 /**
  * @file command.h
- * @brief Ejecucion de comandos, redireccion de salida y manejo de pipes.
+ * @brief Ejecucion de lineas de comandos: listas, pipelines y redirecciones.
  */
 
 #ifndef COMMAND_H
@@ -8,6 +8,9 @@
 
 #include <fcntl.h>
 
+#include "builtins.h"
+#include "jobs.h"
+#include "parser.h"
 #include "process.h"
 
 /**
@@ -18,58 +21,22 @@
 #define MAX_ARGS 100
 
 /**
- * @brief  Máximo número de argumentos para el comando echo.
+ * @brief Analiza y ejecuta una linea de comandos.
  *
- * Esta macro especifica el límite de caracteres que puede procesar el comando echo.
- */
-#define MAX_ECHO_ARGS 1024
-
-/**
- * @brief  Tamaño del buffer de lectura/escritura.
- *
- * Esta macro indica el tamaño máximo en bytes para operaciones de lectura y escritura.
- */
-#define BUFFER_SIZE 1024
-
-/**
- * @brief Convierte subcomandos en una lista de argumentos.
- *
- * Toma una lista de subcomandos separados por tuberías ("|") y los transforma
- * en un arreglo de argumentos para su ejecución.
- *
- * @param subcommands Array de cadenas que representan los subcomandos.
- * @param args Array donde se almacenarán los argumentos convertidos.
- */
-void convert_subcommands_to_args(char* subcommands[], char* args[]);
-
-/**
- * @brief Ejecuta una serie de subcomandos conectados por tuberías.
- *
- * Gestiona la creación de pipes y la ejecución secuencial de comandos.
- *
- * @param subcommands Array de subcomandos separados por "|".
- * @param pipe_count Número de pipes necesarios (cantidad de subcomandos - 1).
- */
-void execPipes(char* subcommands[], int pipe_count);
-
-/**
- * @brief Ejecuta un comando individual.
- *
- * Maneja tanto comandos internos como externos y realiza la ejecución correspondiente.
- *
- * @param args Array de cadenas que representan el comando y sus argumentos.
- */
-void execCommand(char* args[]);
-
-/**
- * @brief Ejecuta un comando con redirección de entrada/salida.
- *
- * Procesa las redirecciones especificadas en el comando y ajusta los descriptores
- * de archivo antes de ejecutar el comando.
+ * La linea pasa por parseLine y el arbol se evalua aca: las listas con `;` y
+ * `&`, `&&` y `||` segun el estado del pipeline anterior, y cada pipeline con
+ * todas sus etapas a la vez en un grupo de procesos propio que recibe la
+ * terminal mientras dura. Cada comando puede tener sus redirecciones (`<`, `>`,
+ * `>>`, `2>`), que tienen prioridad sobre los pipes. Un comando interno solo
+ * corre dentro de la shell, con sus redirecciones; como etapa de un pipeline o
+ * en segundo plano corre en un hijo. Lo que termina en `&` o se detiene con
+ * Ctrl+Z pasa a la tabla de trabajos.
  *
- * @param args Array de cadenas que representan el comando, argumentos y operadores
- * de redirección ("<", ">").
+ * @param line Linea a ejecutar (no se modifica).
+ * @return int Estado del ultimo pipeline: su codigo de salida, 128 + la señal
+ * que lo termino o detuvo, 127 si el programa no existe o 2 si hubo un error de
+ * sintaxis.
  */
-void execCommandWithRedirection(char* args[]);
+int executeLine(const char* line);
 
 #endif // COMMAND_H
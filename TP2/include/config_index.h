@@ -0,0 +1,108 @@
+/**
+ * @file config_index.h
+ * @brief Indice persistente de archivos de configuracion ya leidos.
+ *
+ * Guarda por archivo su ruta, mtime, tamaño y un hash del contenido. Con el
+ * indice, buscarconfig y leerconfig no abren los archivos cuyo mtime y tamaño no
+ * cambiaron, y solo muestran los nuevos o modificados. El archivo es texto, una
+ * linea por entrada: `hash mtime_ns tamaño ruta`.
+ */
+
+#ifndef CONFIG_INDEX_H
+#define CONFIG_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief  Cantidad de listas de la tabla del indice (potencia de 2).
+ */
+#define CONFIG_INDEX_BUCKETS 256
+
+/**
+ * @struct s_config_entry
+ * @brief Archivo del indice.
+ */
+typedef struct s_config_entry
+{
+    char* path;
+    uint64_t hash;    /**< FNV-1a del contenido. */
+    int64_t mtime_ns; /**< Ultima modificacion, en nanosegundos. */
+    int64_t size;
+    int seen;         /**< Se encontro en el recorrido actual. */
+    struct s_config_entry* next;
+} t_config_entry;
+
+/**
+ * @struct s_config_index
+ * @brief Indice cargado en memoria.
+ */
+typedef struct s_config_index
+{
+    char* file; /**< Archivo de donde se cargo y donde se guarda. */
+    t_config_entry* buckets[CONFIG_INDEX_BUCKETS];
+} t_config_index;
+
+/**
+ * @brief Hash FNV-1a de 64 bits de un bloque de memoria.
+ *
+ * @param data Contenido.
+ * @param len Tamaño del contenido.
+ * @return uint64_t Hash.
+ */
+uint64_t hashContent(const void* data, size_t len);
+
+/**
+ * @brief Carga un indice.
+ *
+ * @param index Indice a inicializar.
+ * @param file Archivo del indice; si no existe el indice queda vacio.
+ * @return int 0 si se cargo, -1 con errno si no se pudo leer.
+ */
+int loadConfigIndex(t_config_index* index, const char* file);
+
+/**
+ * @brief Busca un archivo en el indice.
+ *
+ * @param index Indice cargado.
+ * @param path Ruta absoluta del archivo.
+ * @return t_config_entry* La entrada, o NULL si no esta.
+ */
+t_config_entry* findConfigEntry(t_config_index* index, const char* path);
+
+/**
+ * @brief Agrega un archivo al indice (o devuelve su entrada si ya estaba).
+ *
+ * @param index Indice cargado.
+ * @param path Ruta absoluta del archivo.
+ * @return t_config_entry* La entrada, o NULL si no hay memoria.
+ */
+t_config_entry* addConfigEntry(t_config_index* index, const char* path);
+
+/**
+ * @brief Saca un archivo del indice.
+ *
+ * @param index Indice cargado.
+ * @param entry Entrada a sacar; deja de ser valida.
+ */
+void removeConfigEntry(t_config_index* index, t_config_entry* entry);
+
+/**
+ * @brief Guarda el indice en su archivo.
+ *
+ * Se escribe en un archivo temporal que despues reemplaza al anterior, asi que
+ * un corte a mitad de camino no deja un indice a medias.
+ *
+ * @param index Indice cargado.
+ * @return int 0 si se guardo, -1 con errno si no.
+ */
+int saveConfigIndex(const t_config_index* index);
+
+/**
+ * @brief Libera un indice.
+ *
+ * @param index Indice cargado.
+ */
+void freeConfigIndex(t_config_index* index);
+
+#endif // CONFIG_INDEX_H
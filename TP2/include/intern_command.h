@@ -17,6 +17,15 @@
 #include <sys/wait.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+
+#include "config_index.h"
+#include "walker.h"
+#include "writer.h"
 
 /**
  * @brief Longitud máxima para nombres de directorios.
@@ -26,11 +35,9 @@
 #define MAX_DIR_LENGTH 256
 
 /**
- * @brief Longitud máxima de salida para impresión en pantalla.
- *
- * Esta macro especifica el límite de caracteres que pueden imprimirse en una única operación.
+ * @brief Largo de la extension de configuracion mas larga ("properties").
  */
-#define MAX_PRINT 1056
+#define CONFIG_MAX_SUFFIX 10
 
 /**
  * @brief Cambia el directorio de trabajo actual.
@@ -51,37 +58,52 @@ void clearScreen(void);
 /**
  * @brief Imprime un mensaje en pantalla.
  *
- * Procesa y muestra el texto pasado como argumento.
+ * Muestra los argumentos separados por un espacio y un salto de línea al
+ * final. Cada `$NOMBRE` dentro de un argumento se reemplaza por el valor de la
+ * variable de entorno (nada si no existe). La salida se escribe con writev a
+ * partir de los argumentos y los valores de las variables, sin copiarlos, así
+ * que no tiene límite de largo.
  *
- * @param arg Cadena de texto a imprimir.
+ * @param args Comando y argumentos, terminados en `NULL`.
+ * @return int 0 si se escribió todo, 1 si falló la escritura.
  */
-void echoCommand(char* arg);
+int echoCommand(char* args[]);
 
 /**
  * @brief Lista o muestra el contenido de archivos de configuración en un directorio.
  *
- * Busca en el directorio indicado archivos considerados de configuración
- * (como .config, .json, .conf, .cfg, .ini, .yaml, .yml, .env, .toml o .properties)
- * y realiza una acción dependiendo del parámetro 'operacion':
+ * Busca en el directorio indicado archivos considerados de configuración, por
+ * su extension (.config, .json, .conf, .cfg, .ini, .yaml, .yml, .env, .toml o
+ * .properties), y realiza una acción dependiendo del parámetro 'operacion':
  * - "paths": imprime la ruta completa de cada archivo encontrado.
- * - "contenido": imprime el contenido de cada archivo encontrado.
+ * - "contenido": imprime el contenido de cada archivo encontrado, copiado a
+ *   stdout con sendfile (o mmap + write) sin buffers intermedios.
+ *
+ * Con un indice solo se muestran los archivos nuevos o modificados desde la
+ * pasada anterior; los que tienen el mismo mtime y tamaño ni se abren. Tambien
+ * se avisan los que se borraron.
  *
  * @param path Ruta del directorio donde buscar los archivos de configuración.
  * @param operacion Operación a realizar: "paths" para mostrar rutas, 
  *                  "contenido" para mostrar el contenido de los archivos.
+ * @param indice Archivo del indice persistente (ver config_index.h), o NULL
+ *               para mostrar todos los archivos.
  */
-void buscarConfig(char* path, char* operacion);
+void buscarConfig(char* path, char* operacion, const char* indice);
 
 /**
  * @brief Busca archivos con un formato específico de manera recursiva.
  *
- * Busca archivos en el directorio dado y todos sus subdirectorios que terminen
- * con la extensión/patrón indicado.
+ * Busca archivos en el directorio dado y sus subdirectorios cuyo nombre contenga
+ * la extensión/patrón indicado, o que coincida con él si es un glob (`*.conf`).
+ * El recorrido es en paralelo (walkTree), así que las rutas absolutas salen en
+ * cualquier orden.
  *
  * @param path Directorio raíz donde iniciar la búsqueda.
  * @param formato Extensión o patrón del archivo a buscar
+ * @param max_depth Niveles a recorrer (1: solo el directorio raíz), o -1 sin límite.
  */
-void buscarFormato(char* path, const char* formato);
+void buscarFormato(char* path, const char* formato, int max_depth);
 
 /**
  * @brief Verifica si el monitor está en ejecución.
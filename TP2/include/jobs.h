@@ -1,6 +1,12 @@
 /**
  * @file jobs.h
  * @brief Manejo de trabajos en segundo plano y mantencion de su estado.
+ *
+ * Cada pipeline corre en un grupo de procesos propio. Los que quedan en
+ * segundo plano (o se detienen con Ctrl+Z) pasan a la tabla de trabajos. El
+ * manejador de SIGCHLD solo marca que algo cambio; reapJobs recoge los hijos
+ * con waitpid(WNOHANG) desde el ciclo principal, avisa los trabajos que
+ * terminaron y los saca de la tabla.
  */
 
 #ifndef JOBS_H
@@ -11,15 +17,116 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "process.h"
+
+/**
+ * @brief  Largo maximo del texto de un trabajo en la tabla.
+ */
+#define JOB_COMMAND_LENGTH 256
+
+/**
+ * @brief Estado de un trabajo.
+ */
+typedef enum e_job_state
+{
+    JOB_RUNNING, /**< Corriendo. */
+    JOB_STOPPED, /**< Detenido por una señal (Ctrl+Z, SIGTTIN...). */
+    JOB_DONE     /**< Terminaron todos sus procesos. */
+} t_job_state;
+
+/**
+ * @struct s_job
+ * @brief Trabajo: un grupo de procesos lanzado desde una linea.
+ */
+typedef struct s_job
+{
+    int id;      /**< Numero que muestran jobs, fg y bg (0 fuera de la tabla). */
+    pid_t pgid;  /**< Grupo de procesos del trabajo. */
+    pid_t last;  /**< Proceso cuyo estado es el del trabajo (la ultima etapa). */
+    int status;  /**< Estado del trabajo, como lo devuelve executeLine. */
+    t_job_state state;
+    char command[JOB_COMMAND_LENGTH];
+    struct s_job* next;
+} t_job;
+
+/**
+ * @brief Pasa la terminal a un grupo de procesos.
+ *
+ * Mientras tanto se ignora SIGTTOU: un proceso que no esta en primer plano
+ * seria detenido por tcsetpgrp.
+ *
+ * @param pgid Grupo que pasa a primer plano.
+ */
+void giveTerminal(pid_t pgid);
+
+/**
+ * @brief Prepara el control de trabajos de la shell.
+ *
+ * Instala los manejadores de señales. Si stdin es una terminal, espera a estar
+ * en primer plano, pone a la shell en su propio grupo y toma la terminal.
+ */
+void initJobControl(void);
+
+/**
+ * @brief Agrega un trabajo a la tabla.
+ *
+ * @param job Trabajo a copiar; se le asigna el siguiente numero libre.
+ * @return t_job* El trabajo en la tabla, o NULL si no hay memoria.
+ */
+t_job* addJob(const t_job* job);
+
+/**
+ * @brief Espera a un trabajo hasta que termina o se detiene.
+ *
+ * @param job Trabajo a esperar; se actualizan su estado y `status`.
+ * @param foreground Si es distinto de 0 el trabajo recibe la terminal mientras
+ * dura (si la tiene la shell o ya se le dio al trabajo) y las señales de
+ * teclado que le lleguen a la shell.
+ * @return int Estado del trabajo: codigo de salida de la ultima etapa o 128 + la
+ * señal que la termino o detuvo.
+ */
+int waitJob(t_job* job, int foreground);
+
+/**
+ * @brief Recoge los hijos que cambiaron de estado sin bloquear.
+ *
+ * No hace nada si SIGCHLD no llego desde la ultima vez. Avisa por stdout los
+ * trabajos que terminaron o se detuvieron y saca de la tabla los terminados.
+ */
+void reapJobs(void);
+
+/**
+ * @brief Comando interno `jobs`: lista los trabajos de la tabla.
+ *
+ * @param args Comando y argumentos (no se usan).
+ * @return int Siempre 0.
+ */
+int jobsCommand(char* args[]);
+
+/**
+ * @brief Comando interno `fg [%n]`: continua un trabajo en primer plano y lo espera.
+ *
+ * @param args Comando y numero de trabajo (por defecto el ultimo).
+ * @return int Estado del trabajo, o 1 si no existe.
+ */
+int fgCommand(char* args[]);
+
+/**
+ * @brief Comando interno `bg [%n]`: continua un trabajo detenido en segundo plano.
+ *
+ * @param args Comando y numero de trabajo (por defecto el ultimo).
+ * @return int 0, o 1 si no existe.
+ */
+int bgCommand(char* args[]);
+
 /**
- * @brief Ejecuta un comando en segundo plano.
+ * @brief Comando interno `wait [%n...]`: espera a que terminen trabajos.
  *
- * Crea un proceso hijo para ejecutar el comando especificado,
- * permitiendo que el shell continúe funcionando sin esperar su finalización.
+ * Sin argumentos espera a todos. Un trabajo que se detiene deja de esperarse.
  *
- * @param args Comando y argumentos a ejecutar, terminados en `NULL`.
- * @param jobID Identificador del trabajo en segundo plano.
+ * @param args Comando y numeros de trabajo.
+ * @return int Estado del ultimo trabajo esperado, o 127 si alguno no existe.
  */
-void backgroundProcess(char** args, int jobID);
+int waitCommand(char* args[]);
 
 #endif // JOBS_H
@@ -0,0 +1,149 @@
+/**
+ * @file parser.h
+ * @brief Analisis lexico y sintactico de una linea de comandos.
+ *
+ * La linea se recorre una sola vez: el lexer separa palabras (con comillas
+ * simples, dobles y '\') y operadores, y el parser arma un arbol de listas,
+ * pipelines y comandos simples. Todo el arbol (tokens, palabras y nodos) vive
+ * en una arena propia que se libera de una vez con freeAst.
+ *
+ * Gramatica:
+ *
+ *     lista    := and_or ((';' | '&') and_or)* [';' | '&']
+ *     and_or   := pipeline (('&&' | '||') pipeline)*
+ *     pipeline := comando ('|' comando)*
+ *     comando  := (PALABRA | redir)+
+ *     redir    := ('<' | '>' | '>>' | '2>') PALABRA
+ */
+
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stddef.h>
+
+/**
+ * @brief  Tamaño minimo de cada bloque de la arena del arbol.
+ */
+#define AST_CHUNK_SIZE 4096
+
+/**
+ * @brief Tipos de token.
+ */
+typedef enum e_token_kind
+{
+    TOK_WORD,   /**< Palabra, ya sin comillas. */
+    TOK_PIPE,   /**< `|` */
+    TOK_IN,     /**< `<` */
+    TOK_OUT,    /**< `>` */
+    TOK_APPEND, /**< `>>` */
+    TOK_ERR,    /**< `2>` */
+    TOK_BG,     /**< `&` */
+    TOK_SEQ,    /**< `;` */
+    TOK_AND,    /**< `&&` */
+    TOK_OR,     /**< `||` */
+    TOK_END     /**< Fin de la linea. */
+} t_token_kind;
+
+/**
+ * @struct s_token
+ * @brief Token de la linea; la lista siempre termina en TOK_END.
+ */
+typedef struct s_token
+{
+    t_token_kind kind;
+    char* text; /**< Palabra (TOK_WORD) o el operador tal como se escribio. */
+    struct s_token* next;
+} t_token;
+
+/**
+ * @struct s_redir
+ * @brief Redireccion de un comando (TOK_IN, TOK_OUT, TOK_APPEND o TOK_ERR).
+ */
+typedef struct s_redir
+{
+    t_token_kind kind;
+    char* path;
+    struct s_redir* next;
+} t_redir;
+
+/**
+ * @struct s_simple_command
+ * @brief Comando simple: argumentos terminados en NULL y sus redirecciones.
+ */
+typedef struct s_simple_command
+{
+    char** argv; /**< argv[0] es NULL si el comando solo tiene redirecciones. */
+    int argc;
+    t_redir* redirs;
+    struct s_simple_command* next; /**< Siguiente etapa del pipeline. */
+} t_simple_command;
+
+/**
+ * @struct s_pipeline
+ * @brief Comandos conectados por pipes dentro de un and_or.
+ */
+typedef struct s_pipeline
+{
+    t_simple_command* commands;
+    int count;
+    t_token_kind op; /**< TOK_AND o TOK_OR con el pipeline siguiente, TOK_END si es el ultimo. */
+    struct s_pipeline* next;
+} t_pipeline;
+
+/**
+ * @struct s_and_or
+ * @brief Pipelines unidos por `&&` y `||`; un elemento de la lista de la linea.
+ */
+typedef struct s_and_or
+{
+    t_pipeline* pipelines;
+    int background; /**< Termina en `&`: corre sin que la shell lo espere. */
+    struct s_and_or* next;
+} t_and_or;
+
+/**
+ * @struct s_ast
+ * @brief Arbol de una linea y la arena donde vive.
+ */
+typedef struct s_ast
+{
+    t_and_or* list; /**< NULL si la linea esta vacia o es un comentario. */
+    struct s_ast_chunk* arena;
+} t_ast;
+
+/**
+ * @brief Separa una linea en tokens.
+ *
+ * @param line Linea a analizar (no se modifica).
+ * @param ast Arbol cuya arena recibe los tokens.
+ * @return t_token* Lista de tokens terminada en TOK_END, o NULL si hay una
+ * comilla sin cerrar o no hay memoria.
+ */
+t_token* tokenize(const char* line, t_ast* ast);
+
+/**
+ * @brief Analiza una linea y arma su arbol.
+ *
+ * Los errores de sintaxis se informan por stderr.
+ *
+ * @param line Linea a analizar (no se modifica).
+ * @return t_ast* Arbol de la linea, o NULL si tiene un error de sintaxis.
+ */
+t_ast* parseLine(const char* line);
+
+/**
+ * @brief Texto de un operador, para mensajes y para mostrar un comando.
+ *
+ * @param kind Tipo de token distinto de TOK_WORD.
+ * @return const char* El operador como se escribe (`"nueva linea"` para TOK_END).
+ */
+const char* tokenText(t_token_kind kind);
+
+/**
+ * @brief Libera un arbol y todo lo que vive en su arena.
+ *
+ * @param ast Arbol a liberar (puede ser NULL).
+ */
+void freeAst(t_ast* ast);
+
+#endif // PARSER_H
@@ -0,0 +1,60 @@
+/**
+ * @file path_hash.h
+ * @brief Tabla de comandos resueltos en el PATH (como `hash` de bash).
+ */
+
+#ifndef PATH_HASH_H
+#define PATH_HASH_H
+
+#include <stddef.h>
+
+/**
+ * @brief  Cantidad de listas de la tabla de comandos (potencia de 2).
+ */
+#define PATH_HASH_BUCKETS 64
+
+/**
+ * @brief  PATH que se usa si la variable no esta definida (el mismo que execvp).
+ */
+#define DEFAULT_PATH "/bin:/usr/bin"
+
+/**
+ * @brief Devuelve la ruta del ejecutable de un comando.
+ *
+ * La primera vez recorre los directorios del PATH y guarda la ruta encontrada;
+ * las siguientes la toma de la tabla sin tocar el sistema de archivos. Si el
+ * PATH cambio desde la ultima busqueda, la tabla se vacia. Los nombres con '/'
+ * se devuelven tal cual y las rutas relativas (directorios del PATH que no
+ * empiezan con '/') no se guardan.
+ *
+ * @param name Nombre del comando.
+ * @return const char* Ruta del ejecutable (valida hasta la proxima llamada que
+ * modifique la tabla), o NULL si no esta en el PATH.
+ */
+const char* resolveCommand(const char* name);
+
+/**
+ * @brief Borra un comando de la tabla.
+ *
+ * Se usa cuando la ruta guardada ya no existe (ENOENT al ejecutarla).
+ *
+ * @param name Nombre del comando.
+ */
+void forgetCommand(const char* name);
+
+/**
+ * @brief Vacia la tabla de comandos.
+ */
+void clearCommandHash(void);
+
+/**
+ * @brief Comando interno `hash`.
+ *
+ * Sin argumentos lista los comandos guardados con sus usos; `hash -r` vacia la
+ * tabla y `hash <comando>...` busca y guarda los comandos indicados.
+ *
+ * @param args Comando y argumentos, terminados en `NULL`.
+ */
+void hashCommand(char* args[]);
+
+#endif // PATH_HASH_H
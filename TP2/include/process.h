@@ -6,16 +6,41 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <errno.h>
+#include <spawn.h>
+
+#include "path_hash.h"
 #include "signals.h"
 
 /**
- * @brief Ejecuta un programa externo en primer plano.
+ * @struct s_launch
+ * @brief Redirecciones y grupo de procesos para lanzar un programa.
+ */
+typedef struct s_launch
+{
+    int in_fd;  /**< Descriptor que pasa a ser stdin del programa (-1: hereda el de la shell). */
+    int out_fd; /**< Descriptor que pasa a ser stdout del programa (-1: hereda el de la shell). */
+    int err_fd; /**< Descriptor que pasa a ser stderr del programa (-1: hereda el de la shell). */
+    pid_t pgid; /**< Grupo de procesos: -1 el de la shell, 0 uno nuevo, >0 ese grupo. */
+} t_launch;
+
+/**
+ * @brief Lanza un programa externo sin copiar la memoria de la shell.
  *
- * Crea un proceso hijo para ejecutar un programa que no sea un comando interno.
- * El proceso padre espera a que el hijo termine antes de continuar.
+ * Usa posix_spawn (en glibc, clone con CLONE_VM | CLONE_VFORK): el hijo no
+ * duplica las tablas de paginas de la shell, que es lo que domina el costo de
+ * fork con miles de comandos cortos. Las redirecciones se aplican con file
+ * actions; los demas descriptores que la shell tenga abiertos tienen que tener
+ * O_CLOEXEC para no llegar al programa. Las señales que la shell ignore vuelven
+ * a su accion por defecto en el hijo. El ejecutable se busca con
+ * resolveCommand (sin recorrer el PATH en cada comando); si la ruta guardada ya
+ * no existe se olvida y se vuelve a buscar. Un programa que no existe o no se
+ * puede ejecutar se detecta aca, no en el hijo.
  *
- * @param args Comando y argumentos a ejecutar.
+ * @param args Comando y argumentos, terminados en `NULL`.
+ * @param opts Redirecciones y grupo, o NULL para heredar todo de la shell.
+ * @return pid_t PID del hijo, o -1 con errno si no se pudo lanzar.
  */
-void externProgram(char** args);
+pid_t launchProgram(char* const args[], const t_launch* opts);
 
 #endif // PROCESS_H
@@ -5,8 +5,7 @@
 #ifndef SHELL_H
 #define SHELL_H
 
-#include <pthread.h>
-
+#include "batch.h"
 #include "command.h"
 #include "jobs.h"
 
@@ -36,8 +35,8 @@
 /**
  * @brief Ejecuta un archivo de comandos en modo batch.
  *
- * Abre y lee el archivo de comandos línea por línea, ejecutando cada comando de forma secuencial.
- * Si encuentra un comando para ejecutarse en segundo plano, lo maneja adecuadamente.
+ * Abre y lee el archivo de comandos línea por línea y ejecuta cada una con executeLine, de forma
+ * secuencial.
  *
  * @param filename Nombre del archivo de comandos a ejecutar.
  */
@@ -52,44 +51,20 @@ void executeBatchFile(const char* filename);
  */
 char* getPrompt();
 
-/**
- * @brief Elimina las comillas dobles o simples de un argumento para que se puedan procesar archivos escritos tanto con
- * comillas como sin.
- *
- * Si el argumento comienza y termina con comillas, las elimina.
- *
- * @param arg Argumento a procesar.
- */
-void strip_quotes(char* arg);
-
 /**
  * @brief Ejecuta la shell interactiva.
  *
- * Si se proporciona un archivo como argumento, ejecuta el archivo en modo batch.
- * De lo contrario, espera comandos interactivos del usuario y los ejecuta.
- * Determina y llama a los metodos correspondientes dependiendo de que tipo de coando se tratase:
- * - Con redireccion ('<' o '>')
- * - Con pipes
- * - En segundo plano
- * - Comandos internos
- * - Comando en primer plano
+ * Si se proporciona un archivo como argumento, ejecuta el archivo en modo batch; con `-j N`
+ * las lineas corren en paralelo, hasta N a la vez (executeBatchParallel), y la shell sale con
+ * error si alguna fallo.
+ * De lo contrario, espera comandos interactivos del usuario y ejecuta cada linea con executeLine
+ * (listas, pipes, redirecciones, segundo plano y comandos internos).
  *
  * @param argc Número de argumentos.
  * @param argv Arreglo de argumentos, donde el primer argumento es el archivo de comandos.
  */
 void runShell(int argc, char* argv[]);
 
-/**
- * @brief Ejecuta un comando en segundo plano.
- *
- * Asigna un ID de trabajo y llama a `backgroundProcess` para ejecutar el
- * comando en segundo plano.
- *
- * @param args Arreglo de argumentos del comando.
- * @param i Número de argumentos del comando.
- */
-void runBackground(char* args[MAX_ARGS], int i);
-
 /**
  * @brief Modifica las configuraciones del programa de monitoreo.
  *
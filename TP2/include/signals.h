@@ -7,10 +7,23 @@
 
 #include "intern_command.h"
 
+/**
+ * @brief Grupo de procesos del trabajo en primer plano, o -1 si no hay.
+ *
+ * Los manejadores de SIGINT, SIGTSTP y SIGQUIT reenvian la señal a este grupo;
+ * waitJob lo cambia, por eso es volatile sig_atomic_t como child_changed.
+ */
+extern volatile sig_atomic_t foreground_pid;
+
+/**
+ * @brief Lo marca el manejador de SIGCHLD cuando un hijo termina, se detiene o continua.
+ */
+extern volatile sig_atomic_t child_changed;
+
 /**
  * @brief Manejador de la señal SIGINT.
  *
- * Esta función maneja la señal SIGINT (Ctrl+C) y envía la misma señal al proceso en primer plano.
+ * Esta función maneja la señal SIGINT (Ctrl+C) y envía la misma señal al grupo en primer plano.
  *
  * @param sig La señal recibida (no se utiliza en esta implementación).
  */
@@ -19,7 +32,7 @@ void sigint_handler(int sig);
 /**
  * @brief Manejador de la señal SIGTSTP.
  *
- * Esta función maneja la señal SIGTSTP (Ctrl+Z) y envía la misma señal al proceso en primer plano.
+ * Esta función maneja la señal SIGTSTP (Ctrl+Z) y envía la misma señal al grupo en primer plano.
  *
  * @param sig La señal recibida (no se utiliza en esta implementación).
  */
@@ -28,16 +41,25 @@ void sigtstp_handler(int sig);
 /**
  * @brief Manejador de la señal SIGQUIT.
  *
- * Esta función maneja la señal SIGQUIT (Ctrl+\) y envía la misma señal al proceso en primer plano.
+ * Esta función maneja la señal SIGQUIT (Ctrl+\) y envía la misma señal al grupo en primer plano.
  *
  * @param sig La señal recibida (no se utiliza en esta implementación).
  */
 void sigquit_handler(int sig);
 
+/**
+ * @brief Manejador de la señal SIGCHLD.
+ *
+ * Solo marca child_changed; los hijos se recogen despues con reapJobs.
+ *
+ * @param sig La señal recibida (no se utiliza en esta implementación).
+ */
+void sigchld_handler(int sig);
+
 /**
  * @brief Configura los manejadores de señales.
  *
- * Esta función configura los manejadores de las señales SIGINT, SIGTSTP y SIGQUIT.
+ * Esta función configura los manejadores de las señales SIGINT, SIGTSTP, SIGQUIT y SIGCHLD.
  * Asocia cada señal a su respectivo manejador.
  */
 void setup_signal_handlers();
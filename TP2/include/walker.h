@@ -0,0 +1,60 @@
+/**
+ * @file walker.h
+ * @brief Recorrido en paralelo de un arbol de directorios.
+ *
+ * Cada hilo tiene una cola doble de directorios pendientes (Chase-Lev): saca y
+ * agrega por abajo sin locks, y cuando se queda sin trabajo le roba por arriba
+ * a otro hilo; si no hay nada para robar se duerme hasta que se agregue un
+ * directorio o no quede ninguno. Cada directorio se abre con openat relativo
+ * al descriptor de su padre, que queda abierto hasta que se abrieron todos sus
+ * hijos. Los directorios se leen con el d_type de readdir (getdents64), asi que
+ * solo se llama a fstatat, relativo al descriptor del directorio, cuando el
+ * sistema de archivos no informa el tipo o la entrada es un enlace. Las rutas
+ * que coinciden pasan al hilo que llamo por una cola sin locks (muchos
+ * productores, un consumidor), que las entrega en orden de llegada; mientras
+ * esta vacia, ese hilo duerme.
+ */
+
+#ifndef WALKER_H
+#define WALKER_H
+
+/**
+ * @brief  Maximo de hilos del recorrido.
+ */
+#define WALK_MAX_THREADS 64
+
+/**
+ * @brief  Capacidad inicial de la cola de cada hilo (potencia de 2); crece sola.
+ */
+#define WALK_DEQUE_SIZE 256
+
+/**
+ * @struct s_walk_options
+ * @brief Que buscar y con cuantos hilos.
+ */
+typedef struct s_walk_options
+{
+    const char* pattern; /**< Glob (`*`, `?`, `[...]`) o, sin comodines, parte del nombre. */
+    int max_depth;       /**< Niveles a recorrer (1: solo la raiz), o -1 sin limite. */
+    int threads;         /**< Hilos de busqueda, o 0 para uno por CPU. */
+} t_walk_options;
+
+/**
+ * @brief Busca archivos regulares bajo un directorio.
+ *
+ * No entra en enlaces a directorios (evita ciclos), pero un enlace a un
+ * archivo regular cuenta como archivo. Los directorios sin permiso de lectura
+ * se saltean. Las rutas se arman desde la ruta absoluta de la raiz, sin
+ * realpath por resultado ni limite de largo.
+ *
+ * @param root Directorio raiz.
+ * @param options Patron, profundidad e hilos.
+ * @param on_match Se llama desde el hilo que llamo a walkTree por cada archivo
+ * que coincide, en cualquier orden, con su ruta absoluta.
+ * @param ctx Se pasa tal cual a on_match.
+ * @return long Cantidad de archivos encontrados, o -1 si no se pudo abrir la raiz.
+ */
+long walkTree(const char* root, const t_walk_options* options, void (*on_match)(const char* path, void* ctx),
+              void* ctx);
+
+#endif // WALKER_H
@@ -0,0 +1,66 @@
+/**
+ * @file writer.h
+ * @brief Salida de comandos internos con writev, sin copiar el texto.
+ *
+ * El escritor junta punteros a pedazos de texto (argumentos, valores de
+ * variables, separadores) en un arreglo de iovec y los escribe con writev
+ * cuando se llena o al final. El texto no se copia a ningun buffer, asi que no
+ * hay limite de largo y el costo es lineal en lo que se escribe. Los pedazos
+ * tienen que seguir validos hasta el proximo flushWriter.
+ */
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+/**
+ * @brief  Pedazos que se juntan antes de llamar a writev.
+ */
+#define WRITER_IOV 64
+
+/**
+ * @struct s_writer
+ * @brief Pedazos pendientes de escribir en un descriptor.
+ */
+typedef struct s_writer
+{
+    int fd;
+    int count; /**< Pedazos en iov. */
+    int error; /**< errno del primer writev que fallo, 0 si no hubo. */
+    struct iovec iov[WRITER_IOV];
+} t_writer;
+
+/**
+ * @brief Prepara un escritor vacio.
+ *
+ * @param writer Escritor a inicializar.
+ * @param fd Descriptor donde se escribe.
+ */
+void initWriter(t_writer* writer, int fd);
+
+/**
+ * @brief Agrega un pedazo de texto.
+ *
+ * Si ya hay WRITER_IOV pedazos pendientes se escriben antes. Los pedazos
+ * vacios se ignoran.
+ *
+ * @param writer Escritor.
+ * @param data Texto (no se copia).
+ * @param len Largo del texto.
+ */
+void writeSlice(t_writer* writer, const char* data, size_t len);
+
+/**
+ * @brief Escribe los pedazos pendientes.
+ *
+ * Repite writev hasta escribir todo (escrituras parciales, EINTR). Despues de un
+ * error los pedazos se descartan.
+ *
+ * @param writer Escritor.
+ * @return int 0 si se escribio todo, -1 si hubo un error (en writer->error).
+ */
+int flushWriter(t_writer* writer);
+
+#endif // WRITER_H
@@ -0,0 +1,301 @@
+#define _GNU_SOURCE // memfd_create
+
+#include "batch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "command.h"
+
+/**
+ * @struct s_batch_line
+ * @brief Una linea del archivo y lo que se sabe de su ejecucion.
+ */
+typedef struct s_batch_line
+{
+    char* command;
+    int number;     /**< Linea del archivo, desde 1. */
+    pid_t pid;      /**< 0 mientras no se lanzo, -1 si no se pudo lanzar. */
+    int output;     /**< Archivo en memoria con stdout y stderr de la linea. */
+    int status;     /**< Estado como el de executeLine. */
+    int done;
+    struct timespec start;
+    double seconds;
+} t_batch_line;
+
+static double elapsed(const struct timespec* start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// Lee las lineas con algo para ejecutar. Devuelve la cantidad, o -1.
+static int read_lines(const char* filename, t_batch_line** lines)
+{
+    FILE* file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        perror("No se pudo abrir el archivo");
+        return -1;
+    }
+
+    int count = 0;
+    int capacity = 0;
+    int number = 0;
+    char* line = NULL;
+    size_t size = 0;
+    ssize_t len;
+    *lines = NULL;
+    while ((len = getline(&line, &size, file)) != -1)
+    {
+        number++;
+        line[strcspn(line, "\n")] = '\0';
+        const char* text = line + strspn(line, " \t");
+        if (*text == '\0' || *text == '#')
+        {
+            continue;
+        }
+
+        if (count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            t_batch_line* grown = realloc(*lines, (size_t)capacity * sizeof(t_batch_line));
+            if (!grown)
+            {
+                perror("Error al leer el archivo");
+                break;
+            }
+            *lines = grown;
+        }
+        t_batch_line* l = &(*lines)[count];
+        memset(l, 0, sizeof(*l));
+        l->command = strdup(text);
+        l->number = number;
+        l->output = -1;
+        if (l->command)
+        {
+            count++;
+        }
+    }
+
+    free(line);
+    fclose(file);
+    return count;
+}
+
+// Lanza una linea en una copia de la shell con la salida capturada
+static void start_line(t_batch_line* l)
+{
+    clock_gettime(CLOCK_MONOTONIC, &l->start);
+
+    l->output = memfd_create("batch", MFD_CLOEXEC);
+    if (l->output == -1)
+    {
+        perror("memfd_create");
+        l->pid = -1;
+        return;
+    }
+
+    l->pid = fork();
+    if (l->pid == 0)
+    {
+        int null = open("/dev/null", O_RDONLY);
+        dup2(null, STDIN_FILENO);
+        dup2(l->output, STDOUT_FILENO);
+        dup2(l->output, STDERR_FILENO);
+        close(null);
+
+        int status = executeLine(l->command);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(status);
+    }
+    if (l->pid == -1)
+    {
+        perror("fork");
+    }
+}
+
+static void finish_line(t_batch_line* l, int status)
+{
+    l->seconds = elapsed(&l->start);
+    l->status = status;
+    l->done = 1;
+}
+
+// Copia la salida capturada de una linea a stdout y la descarta
+static void flush_output(t_batch_line* l, char* buffer)
+{
+    if (l->output == -1)
+    {
+        return;
+    }
+
+    off_t offset = 0;
+    ssize_t n;
+    while ((n = pread(l->output, buffer, BATCH_COPY_SIZE, offset)) > 0)
+    {
+        offset += n;
+        for (ssize_t written = 0; written < n;)
+        {
+            ssize_t w = write(STDOUT_FILENO, buffer + written, (size_t)(n - written));
+            if (w < 0 && errno != EINTR)
+            {
+                break;
+            }
+            written += w > 0 ? w : 0;
+        }
+    }
+    close(l->output);
+    l->output = -1;
+}
+
+static void print_summary(const t_batch_line* lines, int count, int failed, double total)
+{
+    double busy = 0;
+    for (int i = 0; i < count; i++)
+    {
+        busy += lines[i].seconds;
+    }
+
+    fprintf(stderr, "\n%-6s %-6s %10s  %s\n", "linea", "estado", "tiempo(s)", "comando");
+    for (int i = 0; i < count; i++)
+    {
+        fprintf(stderr, "%-6d %-6d %10.3f  %s\n", lines[i].number, lines[i].status, lines[i].seconds,
+                lines[i].command);
+    }
+    fprintf(stderr, "%d comandos, %d fallaron, %.3f s (%.3f s sumando cada comando)\n", count, failed, total, busy);
+}
+
+int executeBatchParallel(const char* filename, int max_jobs)
+{
+    t_batch_line* lines;
+    int count = read_lines(filename, &lines);
+    if (count < 0)
+    {
+        return -1;
+    }
+    if (max_jobs < 1)
+    {
+        max_jobs = 1;
+    }
+
+    char* buffer = malloc(BATCH_COPY_SIZE);
+    if (!buffer)
+    {
+        perror("Error al reservar memoria");
+        free(lines);
+        return -1;
+    }
+
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    // Lo pendiente de la shell no se tiene que repetir en cada copia
+    fflush(stdout);
+    fflush(stderr);
+
+    int next = 0;    // Proxima linea a lanzar
+    int printed = 0; // Lineas cuya salida ya se escribio
+    int running = 0;
+    int failed = 0;
+    while (printed < count)
+    {
+        while (running < max_jobs && next < count)
+        {
+            t_batch_line* l = &lines[next++];
+            start_line(l);
+            if (l->pid > 0)
+            {
+                running++;
+            }
+            else
+            {
+                finish_line(l, 126);
+            }
+        }
+
+        // La salida se escribe en orden: solo avanza cuando termino la linea siguiente
+        while (printed < count && lines[printed].done)
+        {
+            flush_output(&lines[printed], buffer);
+            failed += lines[printed].status != 0;
+            printed++;
+        }
+        if (running == 0)
+        {
+            continue;
+        }
+
+        int child_status;
+        pid_t pid = waitpid(-1, &child_status, 0);
+        if (pid == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("waitpid");
+            break;
+        }
+        for (int i = printed; i < next; i++)
+        {
+            if (lines[i].pid == pid && !lines[i].done)
+            {
+                finish_line(&lines[i], WIFEXITED(child_status) ? WEXITSTATUS(child_status)
+                                                               : 128 + WTERMSIG(child_status));
+                running--;
+                break;
+            }
+        }
+    }
+
+    // Si waitpid fallo quedan lineas sin terminar: se intenta esperar a cada
+    // hijo por su pid y, si tampoco se puede o no se llego a lanzar, la linea
+    // cuenta como fallida. Las salidas se escriben igual, en orden
+    for (int i = printed; i < count; i++)
+    {
+        t_batch_line* l = &lines[i];
+        if (!l->done && l->pid > 0)
+        {
+            int child_status;
+            pid_t pid;
+            do
+            {
+                pid = waitpid(l->pid, &child_status, 0);
+            } while (pid == -1 && errno == EINTR);
+
+            int status = 126;
+            if (pid == l->pid)
+            {
+                status = WIFEXITED(child_status) ? WEXITSTATUS(child_status) : 128 + WTERMSIG(child_status);
+            }
+            finish_line(l, status);
+        }
+        else if (!l->done)
+        {
+            l->status = 126;
+            l->done = 1;
+        }
+        flush_output(l, buffer);
+        failed += l->status != 0;
+    }
+
+    print_summary(lines, count, failed, elapsed(&begin));
+
+    for (int i = 0; i < count; i++)
+    {
+        free(lines[i].command);
+    }
+    free(lines);
+    free(buffer);
+    return failed;
+}
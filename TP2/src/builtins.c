@@ -0,0 +1,201 @@
+#include "builtins.h"
+
+#include "command.h"
+
+static int builtin_cd(char* args[])
+{
+    changeDirectory(args[1]);
+    return 0;
+}
+
+static int builtin_clr(char* args[])
+{
+    (void)args;
+    clearScreen();
+    return 0;
+}
+
+static int builtin_hash(char* args[])
+{
+    hashCommand(args);
+    return 0;
+}
+
+static int builtin_quit(char* args[])
+{
+    (void)args;
+    exit(0);
+}
+
+static int builtin_buscarconfig(char* args[])
+{
+    if (args[1] == NULL)
+    {
+        fprintf(stderr, "Uso: buscarconfig <directorio> [indice]\n");
+        return 2;
+    }
+    buscarConfig(args[1], "paths", args[2]);
+    return 0;
+}
+
+static int builtin_leerconfig(char* args[])
+{
+    if (args[1] == NULL)
+    {
+        fprintf(stderr, "Uso: leerconfig <directorio> [indice]\n");
+        return 2;
+    }
+    buscarConfig(args[1], "contenido", args[2]);
+    return 0;
+}
+
+static int builtin_buscarformato(char* args[])
+{
+    if (args[1] == NULL || args[2] == NULL)
+    {
+        fprintf(stderr, "Uso: buscarformato <directorio raiz> <formato> [profundidad]\n");
+        return 2;
+    }
+    buscarFormato(args[1], args[2], args[3] != NULL ? atoi(args[3]) : -1);
+    return 0;
+}
+
+static int builtin_start_monitor(char* args[])
+{
+    (void)args;
+    start_monitor();
+    return 0;
+}
+
+static int builtin_stop_monitor(char* args[])
+{
+    (void)args;
+    stop_monitor();
+    return 0;
+}
+
+static int builtin_status_monitor(char* args[])
+{
+    (void)args;
+    status_monitor();
+    return get_isRunning() ? 0 : 1;
+}
+
+// Valores por letra del hash: largo + valor de la primera + valor de la ultima.
+// Se eligieron para que los nombres de la tabla no choquen; al agregar un
+// comando hay que buscar valores nuevos y volver a ubicar la tabla.
+static const unsigned char asso_values[256] = {
+    ['b'] = 4, ['c'] = 3, ['d'] = 7, ['e'] = 9, ['f'] = 1, ['g'] = 5, ['h'] = 0, ['j'] = 10,
+    ['l'] = 8, ['o'] = 5, ['q'] = 0, ['r'] = 3, ['s'] = 0, ['t'] = 2, ['w'] = 7,
+};
+
+// Cada comando en el lugar que le da el hash
+static const t_builtin builtins[BUILTIN_SLOTS] = {
+    [4] = {"hash", builtin_hash},
+    [6] = {"quit", builtin_quit},
+    [8] = {"fg", fgCommand},
+    [9] = {"clr", builtin_clr},
+    [11] = {"bg", bgCommand},
+    [12] = {"cd", builtin_cd},
+    [13] = {"wait", waitCommand},
+    [14] = {"jobs", jobsCommand},
+    [15] = {"stop_monitor", builtin_stop_monitor},
+    [16] = {"start_monitor", builtin_start_monitor},
+    [17] = {"status_monitor", builtin_status_monitor},
+    [18] = {"echo", echoCommand},
+    [21] = {"buscarconfig", builtin_buscarconfig},
+    [22] = {"buscarformato", builtin_buscarformato},
+    [23] = {"leerconfig", builtin_leerconfig},
+};
+
+const t_builtin* findBuiltin(const char* name)
+{
+    size_t len = strlen(name);
+    if (len < BUILTIN_MIN_LENGTH || len > BUILTIN_MAX_LENGTH)
+    {
+        return NULL;
+    }
+
+    size_t key = len + asso_values[(unsigned char)name[0]] + asso_values[(unsigned char)name[len - 1]];
+    if (key >= BUILTIN_SLOTS || builtins[key].name == NULL || strcmp(name, builtins[key].name) != 0)
+    {
+        return NULL;
+    }
+    return &builtins[key];
+}
+
+int runBuiltin(const t_builtin* builtin, char* args[], const t_launch* opts)
+{
+    int fds[3] = {opts ? opts->in_fd : -1, opts ? opts->out_fd : -1, opts ? opts->err_fd : -1};
+    int saved[3] = {-1, -1, -1};
+
+    // Lo pendiente de la shell sale por la salida de antes de la redireccion
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < 3; i++)
+    {
+        if (fds[i] >= 0 && fds[i] != i)
+        {
+            saved[i] = fcntl(i, F_DUPFD_CLOEXEC, 10);
+            dup2(fds[i], i);
+        }
+    }
+
+    int status = builtin->run(args);
+
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < 3; i++)
+    {
+        if (saved[i] != -1)
+        {
+            dup2(saved[i], i);
+            close(saved[i]);
+        }
+    }
+    return status;
+}
+
+pid_t launchBuiltin(const t_builtin* builtin, char* args[], const t_launch* opts)
+{
+    pid_t pid = fork();
+    if (pid != 0)
+    {
+        // Tambien desde el padre: el grupo tiene que existir antes de lanzar la
+        // etapa siguiente o de darle la terminal
+        if (pid > 0 && opts->pgid >= 0)
+        {
+            setpgid(pid, opts->pgid ? opts->pgid : pid);
+        }
+        return pid;
+    }
+
+    if (opts->pgid >= 0)
+    {
+        setpgid(0, opts->pgid);
+    }
+
+    // Las mismas señales que launchProgram devuelve a su accion por defecto
+    int defaults[] = {SIGINT, SIGQUIT, SIGTSTP, SIGTTIN, SIGTTOU, SIGPIPE, SIGCHLD};
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++)
+    {
+        signal(defaults[i], SIG_DFL);
+    }
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigprocmask(SIG_SETMASK, &mask, NULL);
+
+    int fds[3] = {opts->in_fd, opts->out_fd, opts->err_fd};
+    for (int i = 0; i < 3; i++)
+    {
+        if (fds[i] >= 0 && fds[i] != i)
+        {
+            dup2(fds[i], i);
+        }
+    }
+
+    int status = builtin->run(args);
+    fflush(stdout);
+    fflush(stderr);
+    _exit(status);
+}
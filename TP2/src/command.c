@@ -1,240 +1,295 @@
+#define _GNU_SOURCE // pipe2
+
 #include "command.h"
 
-void convert_subcommands_to_args(char* subcommands[], char* args[])
+static void close_redirs(int fds[3])
 {
-    int index = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        if (fds[i] != -1)
+        {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
 
-    for (int i = 0; subcommands[i] != NULL; i++)
+// Abre las redirecciones de un comando en fds (stdin, stdout, stderr; -1 si no
+// hay). Si se repite una, gana la ultima.
+static int open_redirs(const t_redir* r, int fds[3])
+{
+    for (; r != NULL; r = r->next)
+    {
+        int target = STDOUT_FILENO;
+        int flags = O_WRONLY | O_CREAT | O_TRUNC;
+        if (r->kind == TOK_IN)
+        {
+            target = STDIN_FILENO;
+            flags = O_RDONLY;
+        }
+        else if (r->kind == TOK_APPEND)
+        {
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+        }
+        else if (r->kind == TOK_ERR)
+        {
+            target = STDERR_FILENO;
+        }
+
+        // O_CLOEXEC: el archivo llega al programa solo por las file actions
+        int fd = open(r->path, flags | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            perror(r->path);
+            close_redirs(fds);
+            return -1;
+        }
+        if (fds[target] != -1)
+        {
+            close(fds[target]);
+        }
+        fds[target] = fd;
+    }
+    return 0;
+}
+
+// Texto de un pipeline para la tabla de trabajos (hasta `end`, sin incluirlo)
+static void describe(const t_pipeline* p, const t_pipeline* end, char* buffer, size_t size)
+{
+    size_t used = 0;
+    buffer[0] = '\0';
+    for (; p != end && used < size; p = p->next)
     {
-        char* token = strtok(subcommands[i], " "); // Divide el subcomando en tokens
-        while (token != NULL)
+        for (const t_simple_command* c = p->commands; c != NULL && used < size; c = c->next)
         {
-            if (strcmp(token, "|") != 0)
-            { // Si el token no es '|', lo agrega al arreglo
-                args[index++] = token;
+            for (int i = 0; i < c->argc && used < size; i++)
+            {
+                used += (size_t)snprintf(buffer + used, size - used, i ? " %s" : "%s", c->argv[i]);
+            }
+            for (const t_redir* r = c->redirs; r != NULL && used < size; r = r->next)
+            {
+                used += (size_t)snprintf(buffer + used, size - used, " %s %s", tokenText(r->kind), r->path);
             }
-            else
+            if (c->next != NULL && used < size)
             {
-                args[index++] = NULL; // Marca el fin del subcomando
+                used += (size_t)snprintf(buffer + used, size - used, " | ");
             }
-            token = strtok(NULL, " "); // Obtener el siguiente token
+        }
+        if (p->next != end && used < size)
+        {
+            used += (size_t)snprintf(buffer + used, size - used, " %s ", tokenText(p->op));
         }
     }
-
-    args[index] = NULL; // Marca el fin del arreglo completo
 }
 
-void execPipes(char* subcommands[], int num_pipes)
+// Lanza las etapas de un pipeline en el grupo pgid (0: uno nuevo). Devuelve el
+// grupo (0 si no se lanzo nada), en *last el pid de la ultima etapa y en
+// *status el estado que queda si esa etapa no se pudo lanzar.
+static pid_t launch_pipeline(const t_pipeline* p, int interactive, pid_t pgid, pid_t* last, int* status)
 {
-    char* a[MAX_ARGS];
-    convert_subcommands_to_args(subcommands, a);
+    int prev_fd = -1; // Extremo de lectura del pipe de la etapa anterior
 
-    int fds[2];
-    int prev_fd = -1; // Para almacenar el descriptor de lectura previo
-    char buffer[BUFFER_SIZE];
-    ssize_t bytesRead;
+    *last = -1;
+    *status = 0;
 
-    int cmd_start = 0; // Índice donde comienza cada comando
-
-    for (int i = 0; i <= num_pipes; i++)
+    // Se lanzan todas las etapas antes de esperar: corren a la vez y cada una se
+    // bloquea solo cuando su pipe esta lleno o vacio
+    for (const t_simple_command* c = p->commands; c != NULL; c = c->next)
     {
-        if (pipe(fds) == -1)
+        // O_CLOEXEC: cada etapa recibe solo sus dos extremos, como stdin y stdout
+        int fds[2] = {-1, -1};
+        if (c->next != NULL && pipe2(fds, O_CLOEXEC) == -1)
         {
             perror("pipe");
-            exit(EXIT_FAILURE);
+            break;
         }
 
-        pid_t pid = fork();
-        if (pid == -1)
+        // Una redireccion tiene prioridad sobre el pipe, como en sh
+        int redir[3] = {-1, -1, -1};
+        pid_t pid = -1;
+        if (open_redirs(c->redirs, redir) == -1)
         {
-            perror("fork");
-            exit(EXIT_FAILURE);
+            *status = 1;
         }
-
-        if (pid == 0)
-        { // Proceso hijo
-            if (prev_fd != -1)
-            {
-                dup2(prev_fd, STDIN_FILENO); // Redirige la entrada desde el pipe anterior
-                close(prev_fd);
-            }
-            if (i < num_pipes)
+        else if (c->argc > 0)
+        {
+            t_launch opts = {redir[0] != -1 ? redir[0] : prev_fd, redir[1] != -1 ? redir[1] : fds[1], redir[2],
+                             pgid};
+            const t_builtin* builtin = findBuiltin(c->argv[0]);
+            pid = builtin ? launchBuiltin(builtin, c->argv, &opts) : launchProgram(c->argv, &opts);
+            if (pid == -1)
             {
-                dup2(fds[1], STDOUT_FILENO); // Redirige la salida al pipe actual
+                // La etapa siguiente igual corre y lee EOF
+                *status = errno == ENOENT ? 127 : 126;
+                perror(c->argv[0]);
             }
-
-            // Cierra los extremos no utilizados
-            close(fds[0]);
-            close(fds[1]);
-
-            // Ejecutar el comando actual
-            execvp(a[cmd_start], &a[cmd_start]);
-            perror("execvp");
-            exit(EXIT_FAILURE);
         }
-        else
-        {                  // Proceso padre
-            close(fds[1]); // Cierra el extremo de escritura del pipe
-            if (prev_fd != -1)
+        close_redirs(redir);
+
+        if (pid > 0 && pgid == 0)
+        {
+            pgid = pid;
+            if (interactive)
             {
-                close(prev_fd); // Cierra el descriptor anterior ya procesado
+                // Si la etapa ya leyo de la terminal quedo detenida por SIGTTIN
+                giveTerminal(pgid);
+                kill(-pgid, SIGCONT);
             }
-
-            prev_fd = fds[0]; // Almacena el extremo de lectura actual
-            wait(NULL);       // Espera al proceso hijo
+        }
+        if (c->next == NULL)
+        {
+            *last = pid;
         }
 
-        // Mover cmd_start al siguiente subcomando
-        while (a[cmd_start] != NULL)
+        if (prev_fd != -1)
+        {
+            close(prev_fd); // La etapa nueva ya tiene su copia
+        }
+        if (fds[1] != -1)
         {
-            cmd_start++;
+            close(fds[1]); // Solo los hijos escriben en el pipe
         }
-        cmd_start++; // Saltar el NULL que separa los subcomandos
+        prev_fd = fds[0];
     }
 
-    // Leer la salida del último pipe
-    while ((bytesRead = read(prev_fd, buffer, sizeof(buffer) - 1)) > 0)
+    if (prev_fd != -1)
     {
-        buffer[bytesRead] = '\0';
-        printf("%s", buffer);
+        close(prev_fd); // Se corto el pipeline a mitad de camino
     }
-    close(prev_fd); // Cierra el último pipe
+    return pgid;
 }
 
-void execCommand(char* args[])
+// Corre un pipeline y lo espera. Si se detiene (Ctrl+Z) pasa a la tabla de trabajos.
+static int run_pipeline(const t_pipeline* p, int foreground, pid_t group)
 {
-    if (args[0] == NULL)
+    // Un comando interno solo corre en la shell: asi cd, fg o quit la afectan
+    const t_simple_command* c = p->commands;
+    const t_builtin* builtin = p->count == 1 && c->argc > 0 ? findBuiltin(c->argv[0]) : NULL;
+    if (builtin != NULL)
     {
-        printf("No se ingreso ningun comando");
-        return;
+        int redir[3] = {-1, -1, -1};
+        if (open_redirs(c->redirs, redir) == -1)
+        {
+            return 1;
+        }
+        t_launch opts = {redir[0], redir[1], redir[2], -1};
+        int status = runBuiltin(builtin, c->argv, &opts);
+        close_redirs(redir);
+        return status;
     }
 
-    // Comandos internos
-    if (strcmp(args[0], "cd") == 0)
-    {
-        changeDirectory(args[1]);
-    }
-    else if (strcmp(args[0], "clr") == 0)
+    // Solo se maneja la terminal si la shell la tiene en primer plano
+    int interactive = foreground && isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp();
+
+    // Lo que la shell tenga pendiente en stdout va antes que la salida de las etapas
+    fflush(stdout);
+
+    t_job job = {0};
+    pid_t pgid = launch_pipeline(p, interactive, group, &job.last, &job.status);
+    if (pgid == 0)
     {
-        clearScreen();
+        return job.status;
     }
-    else if (strcmp(args[0], "echo") == 0)
-    {
-        char echo_arg[MAX_ECHO_ARGS] = ""; // Buffer para almacenar todos los argumentos concatenados
 
-        for (int i = 1; args[i] != NULL; i++)
+    job.pgid = pgid;
+    int status = waitJob(&job, foreground);
+    if (job.state == JOB_STOPPED)
+    {
+        describe(p, p->next, job.command, sizeof(job.command));
+        t_job* stopped = addJob(&job);
+        if (stopped)
         {
-            strcat(echo_arg, args[i]);
-            if (args[i + 1] != NULL)
-            {
-                strcat(echo_arg, " "); // Agregar un espacio entre los argumentos
-            }
-        }
-
-        echoCommand(echo_arg); // Llamar a echoCommand con todos los argumentos concatenados
-    }
-    else if (strcmp(args[0], "buscarconfig") == 0) {
-        if (args[1] != NULL) {
-            buscarConfig(args[1], "paths"); 
-        } else {
-            fprintf(stderr, "Uso: buscarconfig <directorio>\n");
+            printf("\n[%d]+  Detenido\t%s\n", stopped->id, stopped->command);
         }
     }
-    else if (strcmp(args[0], "leerconfig") == 0) {
-        if (args[1] != NULL) {
-            buscarConfig(args[1], "contenido"); 
-        } else {
-            fprintf(stderr, "Uso: leerconfig <directorio>\n");
-        }
-    }
-    else if (strcmp(args[0], "buscarformato") == 0) {
-        if (args[1] != NULL||args[2] != NULL) {
-            buscarFormato(args[1],args[2]); 
-        } else {
-            fprintf(stderr, "Uso: buscarformato <directorio raiz> <formato>\n");
-        }
-    }
-    else
+    return status;
+}
+
+// `&&` corre el pipeline siguiente si el anterior salio bien, `||` si fallo. Un
+// pipeline salteado deja el estado como estaba.
+static int run_and_or(const t_and_or* a, int foreground, pid_t group)
+{
+    int status = 0;
+    t_token_kind op = TOK_END;
+    for (const t_pipeline* p = a->pipelines; p != NULL; p = p->next)
     {
-        // Invocar programas externos
-        externProgram(args);
+        if ((op == TOK_AND && status != 0) || (op == TOK_OR && status == 0))
+        {
+            op = p->op;
+            continue;
+        }
+        status = run_pipeline(p, foreground, group);
+        op = p->op;
     }
+    return status;
 }
 
-void execCommandWithRedirection(char* args[])
+// Lanza un and_or terminado en `&` como trabajo, sin esperarlo
+static int run_background(const t_and_or* a)
 {
-    int in_fd = -1, out_fd = -1; // Descriptores para redirección
-    char* command[MAX_ARGS];
-    int i = 0, j = 0;
+    fflush(stdout);
 
-    // Procesar los argumentos buscando redirección
-    while (args[i] != NULL)
+    t_job job = {0};
+    if (a->pipelines->next == NULL)
     {
-        if (strcmp(args[i], "<") == 0)
-        { // Redirección de entrada
-            if (args[i + 1] == NULL)
-            {
-                fprintf(stderr, "Error: Archivo no especificado para redirección de entrada\n");
-                return;
-            }
-            in_fd = open(args[i + 1], O_RDONLY);
-            if (in_fd < 0)
-            {
-                perror("Error al abrir archivo de entrada");
-                return;
-            }
-            i += 2; // Saltar operador y archivo
-        }
-        else if (strcmp(args[i], ">") == 0)
-        { // Redirección de salida
-            if (args[i + 1] == NULL)
-            {
-                fprintf(stderr, "Error: Archivo no especificado para redirección de salida\n");
-                return;
-            }
-            out_fd = open(args[i + 1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
-            if (out_fd < 0)
-            {
-                perror("Error al abrir archivo de salida");
-                return;
-            }
-            i += 2; // Saltar operador y archivo
-        }
-        else
+        // Un solo pipeline: sus etapas se lanzan directo en su propio grupo
+        job.pgid = launch_pipeline(a->pipelines, 0, 0, &job.last, &job.status);
+        if (job.pgid == 0)
         {
-            command[j++] = args[i++]; // Agregar argumento al comando
+            return job.status;
         }
     }
-
-    command[j] = NULL; // Terminar el comando
-
-    pid_t pid = fork();
-    if (pid == 0)
-    { // Proceso hijo
-        if (in_fd != -1)
+    else
+    {
+        // `&&` y `||` necesitan a alguien que espere cada pipeline: una copia de
+        // la shell, con todas las etapas en su grupo para que fg y bg las alcancen
+        job.pgid = fork();
+        if (job.pgid == -1)
         {
-            dup2(in_fd, STDIN_FILENO); // Redirigir entrada
-            close(in_fd);
+            perror("fork");
+            return 1;
         }
-        if (out_fd != -1)
+        if (job.pgid == 0)
         {
-            dup2(out_fd, STDOUT_FILENO); // Redirigir salida
-            close(out_fd);
+            setpgid(0, 0);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGQUIT, SIG_DFL);
+            signal(SIGTSTP, SIG_DFL);
+            signal(SIGCHLD, SIG_DFL);
+            int status = run_and_or(a, 0, getpgrp());
+            fflush(stdout);
+            _exit(status);
         }
-        execvp(command[0], command); // Ejecutar comando
-        perror("Error al ejecutar comando");
-        exit(EXIT_FAILURE);
+        setpgid(job.pgid, job.pgid);
+        job.last = job.pgid;
     }
-    else if (pid > 0)
-    { // Proceso padre
-        if (in_fd != -1)
-            close(in_fd);
-        if (out_fd != -1)
-            close(out_fd);
-        wait(NULL); // Esperar al hijo
+
+    describe(a->pipelines, NULL, job.command, sizeof(job.command));
+    t_job* added = addJob(&job);
+    if (!added)
+    {
+        // Sin lugar en la tabla nadie lo recogeria: se espera aca
+        perror("Error al agregar el trabajo");
+        return waitJob(&job, 0);
     }
-    else
+    printf("[%d] %d\n", added->id, added->pgid);
+    return 0;
+}
+
+int executeLine(const char* line)
+{
+    t_ast* ast = parseLine(line);
+    if (ast == NULL)
     {
-        perror("Error al crear proceso");
+        return 2; // Error de sintaxis, ya informado
     }
+
+    int status = 0;
+    for (const t_and_or* a = ast->list; a != NULL; a = a->next)
+    {
+        status = a->background ? run_background(a) : run_and_or(a, 1, 0);
+    }
+
+    freeAst(ast);
+    return status;
 }
@@ -0,0 +1,171 @@
+#include "config_index.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+uint64_t hashContent(const void* data, size_t len)
+{
+    const unsigned char* p = data;
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        h = (h ^ p[i]) * 0x100000001B3ULL;
+    }
+    return h;
+}
+
+static unsigned int hash_path(const char* path)
+{
+    return (unsigned int)hashContent(path, strlen(path)) & (CONFIG_INDEX_BUCKETS - 1);
+}
+
+int loadConfigIndex(t_config_index* index, const char* file)
+{
+    memset(index, 0, sizeof(*index));
+    index->file = strdup(file);
+    if (!index->file)
+    {
+        return -1;
+    }
+
+    FILE* f = fopen(file, "r");
+    if (!f)
+    {
+        // Primer uso: el indice arranca vacio
+        return errno == ENOENT ? 0 : -1;
+    }
+
+    char* line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, f) != -1)
+    {
+        uint64_t hash;
+        int64_t mtime_ns;
+        int64_t file_size;
+        int offset = 0;
+        line[strcspn(line, "\n")] = '\0';
+        if (sscanf(line, "%" SCNx64 " %" SCNd64 " %" SCNd64 " %n", &hash, &mtime_ns, &file_size, &offset) != 3 ||
+            offset == 0)
+        {
+            continue; // Linea rota: ese archivo se vuelve a leer
+        }
+        t_config_entry* entry = addConfigEntry(index, line + offset);
+        if (entry)
+        {
+            entry->hash = hash;
+            entry->mtime_ns = mtime_ns;
+            entry->size = file_size;
+        }
+    }
+
+    free(line);
+    fclose(f);
+    return 0;
+}
+
+t_config_entry* findConfigEntry(t_config_index* index, const char* path)
+{
+    t_config_entry* entry = index->buckets[hash_path(path)];
+    while (entry && strcmp(entry->path, path) != 0)
+    {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+t_config_entry* addConfigEntry(t_config_index* index, const char* path)
+{
+    t_config_entry* entry = findConfigEntry(index, path);
+    if (entry)
+    {
+        return entry;
+    }
+
+    entry = calloc(1, sizeof(t_config_entry));
+    if (!entry || !(entry->path = strdup(path)))
+    {
+        free(entry);
+        return NULL;
+    }
+    unsigned int bucket = hash_path(path);
+    entry->next = index->buckets[bucket];
+    index->buckets[bucket] = entry;
+    return entry;
+}
+
+void removeConfigEntry(t_config_index* index, t_config_entry* entry)
+{
+    for (t_config_entry** e = &index->buckets[hash_path(entry->path)]; *e; e = &(*e)->next)
+    {
+        if (*e == entry)
+        {
+            *e = entry->next;
+            free(entry->path);
+            free(entry);
+            return;
+        }
+    }
+}
+
+int saveConfigIndex(const t_config_index* index)
+{
+    size_t len = strlen(index->file);
+    char* tmp = malloc(len + sizeof(".tmp"));
+    if (!tmp)
+    {
+        return -1;
+    }
+    memcpy(tmp, index->file, len);
+    memcpy(tmp + len, ".tmp", sizeof(".tmp"));
+
+    FILE* f = fopen(tmp, "w");
+    if (!f)
+    {
+        free(tmp);
+        return -1;
+    }
+    for (int i = 0; i < CONFIG_INDEX_BUCKETS; i++)
+    {
+        for (const t_config_entry* e = index->buckets[i]; e; e = e->next)
+        {
+            // Una ruta con salto de linea romperia el formato: no se guarda
+            if (!strchr(e->path, '\n'))
+            {
+                fprintf(f, "%016" PRIx64 " %" PRId64 " %" PRId64 " %s\n", e->hash, e->mtime_ns, e->size, e->path);
+            }
+        }
+    }
+
+    int ok = fflush(f) == 0 && !ferror(f);
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmp, index->file) != 0)
+    {
+        int err = errno;
+        unlink(tmp);
+        free(tmp);
+        errno = err;
+        return -1;
+    }
+    free(tmp);
+    return 0;
+}
+
+void freeConfigIndex(t_config_index* index)
+{
+    for (int i = 0; i < CONFIG_INDEX_BUCKETS; i++)
+    {
+        while (index->buckets[i])
+        {
+            t_config_entry* next = index->buckets[i]->next;
+            free(index->buckets[i]->path);
+            free(index->buckets[i]);
+            index->buckets[i] = next;
+        }
+    }
+    free(index->file);
+    index->file = NULL;
+}
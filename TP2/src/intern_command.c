@@ -1,5 +1,7 @@
 #include "intern_command.h"
 
+extern char** environ;
+
 void changeDirectory(char* path)
 {
     char* oldpwd = getenv("PWD");
@@ -58,154 +60,339 @@ void clearScreen()
     }
 }
 
-void echoCommand(char* arg)
+// Valor de la variable de entorno name[0..len) sin copiar el nombre para getenv
+static const char* env_value(const char* name, size_t len)
 {
-    if (arg == NULL)
+    for (char** e = environ; *e != NULL; e++)
     {
-        fprintf(stderr, "Error: argumento vacío\n");
-        return;
+        if (strncmp(*e, name, len) == 0 && (*e)[len] == '=')
+        {
+            return *e + len + 1;
+        }
     }
+    return NULL;
+}
 
-    char result[MAX_PRINT] = "";    // Buffer para almacenar el resultado final
-    char* token = strtok(arg, " "); // Dividir la entrada en tokens separadas por espacios
+static int is_name_char(char c, int first)
+{
+    return c == '_' || isalpha((unsigned char)c) || (!first && isdigit((unsigned char)c));
+}
+
+int echoCommand(char* args[])
+{
+    t_writer out;
+    initWriter(&out, STDOUT_FILENO);
 
-    while (token != NULL)
+    // Lo que la shell tenga pendiente en stdout va antes
+    fflush(stdout);
+
+    for (int i = 1; args[i] != NULL; i++)
     {
-        if (token[0] == '$')
+        if (i > 1)
+        {
+            writeSlice(&out, " ", 1); // Un espacio entre los argumentos
+        }
+
+        // Cada argumento sale en pedazos: el texto literal entre variables y el
+        // valor de cada $NOMBRE, todos apuntando a donde ya estan
+        const char* literal = args[i];
+        const char* p = args[i];
+        while ((p = strchr(p, '$')) != NULL)
         {
-            // Es una variable de entorno
-            char* env_value = getenv(token + 1); // Obtener el valor de la variable sin el '$'
-            if (env_value)
+            size_t len = 0;
+            while (is_name_char(p[1 + len], len == 0))
             {
-                strcat(result, env_value); // Concatenar el valor de la variable al resultado
+                len++;
             }
-            else
+            if (len == 0)
             {
-                strcat(result, ""); // Si no se encuentra la variable, no hacer nada
+                p++; // Un '$' sin nombre es texto
+                continue;
             }
-        }
-        else
-        {
-            // Texto literal
-            strcat(result, token); // Concatenar el texto literal al resultado
-        }
 
-        strcat(result, " ");       // Agregar un espacio después de cada argumento
-        token = strtok(NULL, " "); // Avanzar al siguiente token
+            writeSlice(&out, literal, (size_t)(p - literal));
+            const char* value = env_value(p + 1, len);
+            if (value)
+            {
+                writeSlice(&out, value, strlen(value));
+            }
+            p += 1 + len;
+            literal = p;
+        }
+        writeSlice(&out, literal, strlen(literal));
     }
+    writeSlice(&out, "\n", 1);
 
-    // Imprimir el resultado final, eliminando el espacio extra al final
-    if (strlen(result) > 0)
+    if (flushWriter(&out) == -1)
     {
-        result[strlen(result) - 1] = '\0'; // Quitar el espacio extra al final
+        fprintf(stderr, "echo: %s\n", strerror(out.error));
+        return 1;
+    }
+    return 0;
+}
+
+// Extensiones de configuracion agrupadas por largo: cada nombre se compara solo
+// con las de su mismo largo
+static const char* const config_suffixes[CONFIG_MAX_SUFFIX + 1][4] = {
+    [3] = {"cfg", "env", "ini", "yml"},
+    [4] = {"conf", "json", "toml", "yaml"},
+    [6] = {"config"},
+    [10] = {"properties"},
+};
+
+static int is_config_file(const char* name) {
+    const char* dot = strrchr(name, '.');
+    if (!dot) {
+        return 0;
+    }
+    size_t len = strlen(++dot);
+    if (len > CONFIG_MAX_SUFFIX) {
+        return 0;
     }
+    for (int i = 0; i < 4 && config_suffixes[len][i]; i++) {
+        if (memcmp(dot, config_suffixes[len][i], len) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
 
-    printf("%s\n", result); // Imprimir el resultado
+static int write_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
 }
 
-void buscarConfig(char* path, char* operacion){
-    DIR* dir = opendir(path);
-    if (!dir) {
-        perror("No se puede abrir el directorio");
+// Copia un archivo a stdout sin pasar por buffers propios: sendfile y, si stdout
+// no lo admite, mmap + write
+static void emit_file(int fd, size_t size) {
+    off_t offset = 0;
+    while ((size_t)offset < size) {
+        ssize_t n = sendfile(STDOUT_FILENO, fd, &offset, size - (size_t)offset);
+        if (n == 0) {
+            return; // Fin del archivo: se achico despues del stat
+        }
+        if (n < 0 && errno != EINTR) {
+            if (errno != EINVAL && errno != ENOSYS) {
+                return;
+            }
+            break;
+        }
+    }
+    if ((size_t)offset >= size) {
         return;
     }
 
-    struct dirent* entry;
-    char fullpath[MAX_DIR_LENGTH];
-    int found = 0; // contador de archivos encontrados
+    // Se mapea lo que mide ahora: leer un mmap mas alla del final da SIGBUS
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat");
+        return;
+    }
+    if ((size_t)st.st_size < size) {
+        size = (size_t)st.st_size;
+    }
+    if ((size_t)offset >= size) {
+        return;
+    }
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        return;
+    }
+    write_all(STDOUT_FILENO, (const char*)data + offset, size - (size_t)offset);
+    munmap(data, size);
+}
 
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
-            continue;
+static void show_file(const char* fullpath, int fd, const void* data, size_t size) {
+    printf("=== Contenido de %s ===\n", fullpath);
+    fflush(stdout);
+    if (data) {
+        write_all(STDOUT_FILENO, data, size);
+    } else {
+        emit_file(fd, size);
+    }
+    printf("\n------------------------\n\n");
+}
 
-        snprintf(fullpath, MAX_DIR_LENGTH, "%s/%s", path, entry->d_name);
+// Con indice: devuelve 1 si el archivo es nuevo o cambio (y lo muestra), 0 si no
+static int check_indexed(t_config_index* index, int dir_fd, const char* name, const char* fullpath,
+                         const struct stat* st, int contenido) {
+    int64_t mtime_ns = (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+    t_config_entry* entry = findConfigEntry(index, fullpath);
+    if (entry && entry->mtime_ns == mtime_ns && entry->size == st->st_size) {
+        entry->seen = 1;
+        return 0; // Mismo mtime y tamaño: ni se abre
+    }
 
-        struct stat st;
-        if (stat(fullpath, &st) == -1)
-            continue;
+    int fd = openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        perror(fullpath);
+        return 0;
+    }
+    // El stat de antes puede estar viejo: si el archivo se achico, mapear ese
+    // tamaño da SIGBUS al hashear
+    struct stat cur;
+    if (fstat(fd, &cur) == -1) {
+        perror(fullpath);
+        close(fd);
+        return 0;
+    }
+    mtime_ns = (int64_t)cur.st_mtim.tv_sec * 1000000000 + cur.st_mtim.tv_nsec;
+    size_t size = (size_t)cur.st_size;
+    void* data = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    if (data == MAP_FAILED) {
+        perror(fullpath);
+        close(fd);
+        return 0;
+    }
 
-        if (S_ISREG(st.st_mode)) {
-            if (strstr(entry->d_name, ".config") || strstr(entry->d_name, ".json") ||
-                strstr(entry->d_name, ".conf")   || strstr(entry->d_name, ".cfg")  ||
-                strstr(entry->d_name, ".ini")    || strstr(entry->d_name, ".yaml") ||
-                strstr(entry->d_name, ".yml")    || strstr(entry->d_name, ".env")  ||
-                strstr(entry->d_name, ".toml")   || strstr(entry->d_name, ".properties")) {
-
-                char abs_path[MAX_DIR_LENGTH];
-                if (realpath(fullpath, abs_path)) { // Ruta absoluta
-                    found++;
-                    if (strcmp(operacion, "paths") == 0) {
-                        printf("%s\n", abs_path);
-                    } else if (strcmp(operacion, "contenido") == 0) {
-                        FILE* f = fopen(abs_path, "r");
-                        if (!f) {
-                            perror(abs_path);
-                            continue;
-                        }
-                        printf("=== Contenido de %s ===\n", abs_path);
-                        char buffer[1024];
-                        while (fgets(buffer, sizeof(buffer), f)) {
-                            printf("%s", buffer);
-                        }
-                        printf("\n------------------------\n\n");
-                        fclose(f);
-                    } else {
-                        printf("Operación desconocida: %s\n", operacion);
-                    }
-                } else {
-                    perror("realpath");
-                }
-            }
+    // Un archivo tocado pero con el mismo contenido no se vuelve a mostrar
+    uint64_t hash = hashContent(data, size);
+    int changed = !entry || entry->hash != hash;
+    if (changed) {
+        if (contenido) {
+            show_file(fullpath, fd, data ? data : "", size);
+        } else {
+            printf("%s\n", fullpath);
         }
     }
+    if (!entry) {
+        entry = addConfigEntry(index, fullpath);
+    }
+    if (entry) {
+        entry->hash = hash;
+        entry->mtime_ns = mtime_ns;
+        entry->size = cur.st_size;
+        entry->seen = 1;
+    }
 
-    if (found == 0) {
-        printf("No se encontraron archivos de configuración en: %s\n", path);
+    if (data) {
+        munmap(data, size);
     }
+    close(fd);
+    return changed;
+}
 
-    closedir(dir);
+// Saca del indice los archivos de este directorio que ya no estan
+static void drop_missing(t_config_index* index, const char* dir) {
+    size_t len = strlen(dir);
+    for (int i = 0; i < CONFIG_INDEX_BUCKETS; i++) {
+        t_config_entry* entry = index->buckets[i];
+        while (entry) {
+            t_config_entry* next = entry->next;
+            const char* p = entry->path;
+            if (!entry->seen && strncmp(p, dir, len) == 0 && p[len] == '/' && !strchr(p + len + 1, '/')) {
+                printf("Eliminado: %s\n", p);
+                removeConfigEntry(index, entry);
+            }
+            entry = next;
+        }
+    }
 }
 
-void buscarFormato(char* path, const char* formato) {
-    if (access(path, R_OK) != 0) {
-        return; // Ignora directorios sin permisos
+void buscarConfig(char* path, char* operacion, const char* indice) {
+    int contenido = strcmp(operacion, "contenido") == 0;
+    if (!contenido && strcmp(operacion, "paths") != 0) {
+        printf("Operación desconocida: %s\n", operacion);
+        return;
     }
-    DIR* dir = opendir(path);
+
+    // Una sola ruta absoluta para el directorio; cada archivo se nombra desde ella
+    char* dir_path = realpath(path, NULL);
+    DIR* dir = dir_path ? opendir(dir_path) : NULL;
     if (!dir) {
         perror("No se puede abrir el directorio");
+        free(dir_path);
+        return;
+    }
+    int dir_fd = dirfd(dir);
+
+    t_config_index index;
+    if (indice && loadConfigIndex(&index, indice) == -1) {
+        perror(indice);
+        freeConfigIndex(&index);
+        closedir(dir);
+        free(dir_path);
         return;
     }
 
     struct dirent* entry;
-    char fullpath[MAX_DIR_LENGTH];
+    char fullpath[PATH_MAX + NAME_MAX + 2];
+    int found = 0;     // contador de archivos encontrados
+    int unchanged = 0; // con indice: archivos que no se volvieron a leer
 
     while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        if (!is_config_file(entry->d_name))
             continue;
 
-        snprintf(fullpath, MAX_DIR_LENGTH, "%s/%s", path, entry->d_name);
-
+        // El tipo sale de readdir; solo se pide stat si hace falta
         struct stat st;
-        if (stat(fullpath, &st) == -1)
+        int need_stat = indice || contenido || entry->d_type != DT_REG;
+        if (need_stat && fstatat(dir_fd, entry->d_name, &st, 0) == -1)
+            continue;
+        if (need_stat ? !S_ISREG(st.st_mode) : entry->d_type != DT_REG)
             continue;
 
-        if (S_ISDIR(st.st_mode)) {
-            // Recursión en subdirectorio
-            buscarFormato(fullpath, formato);
-        } else if (S_ISREG(st.st_mode)) {
-            // Verificar coincidencia con el formato
-            if (strstr(entry->d_name, formato)) {
-                char abs_path[MAX_DIR_LENGTH];
-                if (realpath(fullpath, abs_path)) {
-                    printf("%s\n", abs_path);
-                } else {
-                    perror("realpath");
-                }
+        snprintf(fullpath, sizeof(fullpath), "%s/%s", dir_path, entry->d_name);
+        found++;
+
+        if (indice) {
+            unchanged += !check_indexed(&index, dir_fd, entry->d_name, fullpath, &st, contenido);
+        } else if (!contenido) {
+            printf("%s\n", fullpath);
+        } else {
+            int fd = openat(dir_fd, entry->d_name, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                perror(fullpath);
+                continue;
             }
+            show_file(fullpath, fd, NULL, (size_t)st.st_size);
+            close(fd);
+        }
+    }
+
+    if (indice) {
+        drop_missing(&index, dir_path);
+        if (saveConfigIndex(&index) == -1) {
+            perror(indice);
+        }
+        if (unchanged > 0) {
+            printf("%d archivos sin cambios desde el indice\n", unchanged);
         }
+        freeConfigIndex(&index);
+    }
+
+    if (found == 0) {
+        printf("No se encontraron archivos de configuración en: %s\n", path);
     }
 
     closedir(dir);
+    free(dir_path);
+}
+
+// Cada resultado del recorrido se imprime apenas llega
+static void print_match(const char* path, void* ctx)
+{
+    (void)ctx;
+    fputs(path, stdout);
+    putchar('\n');
+}
+
+void buscarFormato(char* path, const char* formato, int max_depth) {
+    t_walk_options options = {formato, max_depth, 0};
+    if (walkTree(path, &options, print_match, NULL) < 0) {
+        perror("No se puede abrir el directorio");
+    }
 }
 
 bool isRunning = false;
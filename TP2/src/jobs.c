@@ -1,29 +1,340 @@
 #include "jobs.h"
 
-void backgroundProcess(char** args, int jobID)
+// Tabla de trabajos ordenada por numero
+static t_job* jobs = NULL;
+
+static int status_of(int child_status)
+{
+    if (WIFEXITED(child_status))
+    {
+        return WEXITSTATUS(child_status);
+    }
+    if (WIFSIGNALED(child_status))
+    {
+        return 128 + WTERMSIG(child_status);
+    }
+    return 128 + WSTOPSIG(child_status);
+}
+
+void giveTerminal(pid_t pgid)
+{
+    void (*old)(int) = signal(SIGTTOU, SIG_IGN);
+    tcsetpgrp(STDIN_FILENO, pgid);
+    signal(SIGTTOU, old);
+}
+
+void initJobControl(void)
 {
-    pid_t pid = fork(); // Creación de un nuevo proceso
+    setup_signal_handlers();
 
-    if (pid < 0)
+    if (!isatty(STDIN_FILENO))
     {
-        // Error al crear el proceso
-        perror("Error al crear el proceso en segundo plano");
         return;
     }
 
-    if (pid == 0)
+    // Si la shell arranco en segundo plano espera a que la pongan en primer plano
+    while (tcgetpgrp(STDIN_FILENO) != getpgrp())
     {
-        // Proceso hijo
-        printf("\n");
-        if (execvp(args[0], args) == -1)
+        kill(0, SIGTTIN);
+    }
+    setpgid(0, 0);
+    giveTerminal(getpgrp());
+}
+
+t_job* addJob(const t_job* job)
+{
+    t_job* copy = malloc(sizeof(t_job));
+    if (!copy)
+    {
+        return NULL;
+    }
+    *copy = *job;
+    copy->next = NULL;
+
+    // El numero nuevo es uno mas que el del ultimo trabajo, como en bash
+    t_job** tail = &jobs;
+    copy->id = 1;
+    while (*tail)
+    {
+        copy->id = (*tail)->id + 1;
+        tail = &(*tail)->next;
+    }
+    *tail = copy;
+    return copy;
+}
+
+static void remove_job(t_job* job)
+{
+    for (t_job** it = &jobs; *it; it = &(*it)->next)
+    {
+        if (*it == job)
+        {
+            *it = job->next;
+            free(job);
+            return;
+        }
+    }
+}
+
+// Aplica un cambio de estado informado por waitpid
+static void update_job(t_job* job, pid_t pid, int child_status)
+{
+    if (WIFSTOPPED(child_status))
+    {
+        job->state = JOB_STOPPED;
+        job->status = status_of(child_status);
+    }
+    else if (WIFCONTINUED(child_status))
+    {
+        job->state = JOB_RUNNING;
+    }
+    else if (pid == job->last)
+    {
+        job->status = status_of(child_status);
+    }
+}
+
+int waitJob(t_job* job, int foreground)
+{
+    // Solo se maneja la terminal si la tiene la shell o ya se le paso al trabajo
+    pid_t owner = isatty(STDIN_FILENO) ? tcgetpgrp(STDIN_FILENO) : -1;
+    int interactive = foreground && (owner == getpgrp() || owner == job->pgid);
+    if (interactive)
+    {
+        giveTerminal(job->pgid);
+    }
+    if (foreground)
+    {
+        foreground_pid = job->pgid;
+    }
+
+    // Se espera a todo el grupo; ECHILD indica que no queda ningun proceso
+    job->state = JOB_RUNNING;
+    while (job->state == JOB_RUNNING)
+    {
+        int child_status;
+        pid_t pid = waitpid(-job->pgid, &child_status, WUNTRACED);
+        if (pid > 0)
+        {
+            update_job(job, pid, child_status);
+        }
+        else if (errno != EINTR)
+        {
+            job->state = JOB_DONE;
+        }
+    }
+
+    if (foreground)
+    {
+        foreground_pid = -1;
+    }
+    if (interactive)
+    {
+        giveTerminal(getpgrp());
+    }
+    return job->status;
+}
+
+static const char* state_text(const t_job* job, char* buffer, size_t size)
+{
+    if (job->state == JOB_RUNNING)
+    {
+        return "Ejecutando";
+    }
+    if (job->state == JOB_STOPPED)
+    {
+        return "Detenido";
+    }
+    if (job->status == 0)
+    {
+        return "Hecho";
+    }
+    if (job->status > 128)
+    {
+        snprintf(buffer, size, "Señal %d", job->status - 128);
+    }
+    else
+    {
+        snprintf(buffer, size, "Salida %d", job->status);
+    }
+    return buffer;
+}
+
+static void print_job(const t_job* job)
+{
+    char buffer[32];
+    printf("[%d]%c  %-12s\t%s%s\n", job->id, job->next ? ' ' : '+', state_text(job, buffer, sizeof(buffer)),
+           job->command, job->state == JOB_RUNNING ? " &" : "");
+}
+
+void reapJobs(void)
+{
+    if (!child_changed)
+    {
+        return;
+    }
+    // Se limpia antes de recoger: un hijo que termine ahora vuelve a marcarlo
+    child_changed = 0;
+
+    t_job* job = jobs;
+    while (job)
+    {
+        t_job* next = job->next;
+        t_job_state before = job->state;
+
+        int child_status;
+        pid_t pid;
+        while ((pid = waitpid(-job->pgid, &child_status, WNOHANG | WUNTRACED | WCONTINUED)) != 0)
+        {
+            if (pid > 0)
+            {
+                update_job(job, pid, child_status);
+            }
+            else if (errno != EINTR)
+            {
+                job->state = JOB_DONE;
+                break;
+            }
+        }
+
+        if (job->state != before && job->state != JOB_RUNNING)
+        {
+            print_job(job);
+        }
+        if (job->state == JOB_DONE)
+        {
+            remove_job(job);
+        }
+        job = next;
+    }
+    fflush(stdout);
+}
+
+// Busca el trabajo de un argumento "%n" o "n"; sin argumento, el ultimo
+static t_job* find_job(const char* name, const char* spec)
+{
+    t_job* job = jobs;
+    if (spec == NULL)
+    {
+        while (job && job->next)
         {
-            perror("Error al ejecutar el programa en segundo plano");
-            exit(EXIT_FAILURE);
+            job = job->next;
         }
     }
     else
     {
-        // Proceso padre
-        printf("[%d] %d \n", jobID, pid);
+        int id = atoi(spec[0] == '%' ? spec + 1 : spec);
+        while (job && job->id != id)
+        {
+            job = job->next;
+        }
+    }
+
+    if (!job)
+    {
+        fprintf(stderr, "%s: %s: no existe ese trabajo\n", name, spec ? spec : "actual");
+    }
+    return job;
+}
+
+int jobsCommand(char* args[])
+{
+    (void)args;
+    // Lo que termino desde el ultimo aviso se muestra una vez y se saca
+    reapJobs();
+    for (t_job* job = jobs; job; job = job->next)
+    {
+        print_job(job);
+    }
+    return 0;
+}
+
+int fgCommand(char* args[])
+{
+    t_job* job = find_job("fg", args[1]);
+    if (!job)
+    {
+        return 1;
+    }
+
+    printf("%s\n", job->command);
+    fflush(stdout);
+
+    // Recibe la terminal antes de continuar, por si lee de ella enseguida
+    if (isatty(STDIN_FILENO) && tcgetpgrp(STDIN_FILENO) == getpgrp())
+    {
+        giveTerminal(job->pgid);
+    }
+    kill(-job->pgid, SIGCONT);
+
+    int status = waitJob(job, 1);
+    if (job->state == JOB_STOPPED)
+    {
+        printf("\n");
+        print_job(job);
+    }
+    else
+    {
+        remove_job(job);
+    }
+    return status;
+}
+
+int bgCommand(char* args[])
+{
+    t_job* job = find_job("bg", args[1]);
+    if (!job)
+    {
+        return 1;
+    }
+
+    job->state = JOB_RUNNING;
+    kill(-job->pgid, SIGCONT);
+    printf("[%d] %s &\n", job->id, job->command);
+    return 0;
+}
+
+int waitCommand(char* args[])
+{
+    int status = 0;
+    if (args[1] == NULL)
+    {
+        // Se saca cada trabajo terminado antes de esperar al siguiente
+        t_job* job = jobs;
+        while (job)
+        {
+            t_job* next = job->next;
+            if (job->state != JOB_STOPPED)
+            {
+                status = waitJob(job, 0);
+                if (job->state == JOB_DONE)
+                {
+                    remove_job(job);
+                }
+            }
+            job = next;
+        }
+        return status;
+    }
+
+    for (int i = 1; args[i] != NULL; i++)
+    {
+        t_job* job = find_job("wait", args[i]);
+        if (!job)
+        {
+            status = 127;
+            continue;
+        }
+        if (job->state == JOB_STOPPED)
+        {
+            status = job->status;
+            continue;
+        }
+        status = waitJob(job, 0);
+        if (job->state == JOB_DONE)
+        {
+            remove_job(job);
+        }
     }
+    return status;
 }
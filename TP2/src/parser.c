@@ -0,0 +1,371 @@
+#include "parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @struct s_ast_chunk
+ * @brief Bloque de la arena del arbol: se asigna avanzando `used`.
+ */
+struct s_ast_chunk
+{
+    struct s_ast_chunk* next;
+    size_t size;
+    size_t used;
+    max_align_t data[];
+};
+
+// Texto de cada operador, para los mensajes de error
+static const char* const op_text[] = {
+    [TOK_PIPE] = "|", [TOK_IN] = "<", [TOK_OUT] = ">", [TOK_APPEND] = ">>", [TOK_ERR] = "2>",
+    [TOK_BG] = "&",   [TOK_SEQ] = ";", [TOK_AND] = "&&", [TOK_OR] = "||",    [TOK_END] = "nueva linea",
+};
+
+// Memoria en cero de la arena; nada se libera hasta freeAst
+static void* ast_alloc(t_ast* ast, size_t size)
+{
+    size = (size + sizeof(max_align_t) - 1) & ~(sizeof(max_align_t) - 1);
+    struct s_ast_chunk* c = ast->arena;
+    if (!c || c->size - c->used < size)
+    {
+        size_t len = size > AST_CHUNK_SIZE ? size : AST_CHUNK_SIZE;
+        c = malloc(sizeof(*c) + len);
+        if (!c)
+        {
+            return NULL;
+        }
+        c->size = len;
+        c->used = 0;
+        c->next = ast->arena;
+        ast->arena = c;
+    }
+    void* p = (char*)c->data + c->used;
+    c->used += size;
+    memset(p, 0, size);
+    return p;
+}
+
+static int is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int is_operator(char c)
+{
+    return c == '|' || c == '&' || c == ';' || c == '<' || c == '>';
+}
+
+static int is_redir(t_token_kind kind)
+{
+    return kind == TOK_IN || kind == TOK_OUT || kind == TOK_APPEND || kind == TOK_ERR;
+}
+
+// Copia una palabra sin comillas en `out` y devuelve donde termina en la linea,
+// o NULL si queda una comilla sin cerrar
+static const char* read_word(const char* s, char** out)
+{
+    char* w = *out;
+    while (*s && !is_blank(*s) && !is_operator(*s))
+    {
+        if (*s == '\'')
+        {
+            // Entre comillas simples todo es literal
+            const char* end = strchr(s + 1, '\'');
+            if (!end)
+            {
+                return NULL;
+            }
+            memcpy(w, s + 1, (size_t)(end - s - 1));
+            w += end - s - 1;
+            s = end + 1;
+        }
+        else if (*s == '"')
+        {
+            // Entre comillas dobles solo se escapan '"' y '\'
+            for (s++; *s != '"'; s++)
+            {
+                if (!*s)
+                {
+                    return NULL;
+                }
+                if (*s == '\\' && (s[1] == '"' || s[1] == '\\'))
+                {
+                    s++;
+                }
+                *w++ = *s;
+            }
+            s++;
+        }
+        else if (*s == '\\' && s[1])
+        {
+            *w++ = s[1];
+            s += 2;
+        }
+        else
+        {
+            *w++ = *s++;
+        }
+    }
+    *w++ = '\0';
+    *out = w;
+    return s;
+}
+
+t_token* tokenize(const char* line, t_ast* ast)
+{
+    // Cada palabra ocupa a lo sumo lo mismo que en la linea mas su '\0': todas
+    // entran en un unico bloque
+    size_t len = strlen(line);
+    char* words = ast_alloc(ast, 2 * len + 2);
+    if (!words)
+    {
+        return NULL;
+    }
+
+    t_token head = {TOK_END, NULL, NULL};
+    t_token* tail = &head;
+    const char* s = line;
+    while (1)
+    {
+        while (is_blank(*s))
+        {
+            s++;
+        }
+        t_token* t = ast_alloc(ast, sizeof(t_token));
+        if (!t)
+        {
+            return NULL;
+        }
+        tail->next = t;
+        tail = t;
+
+        // Un '#' al inicio de una palabra comenta el resto de la linea
+        if (!*s || *s == '#')
+        {
+            t->kind = TOK_END;
+            t->text = (char*)op_text[TOK_END];
+            return head.next;
+        }
+
+        if (s[0] == '2' && s[1] == '>')
+        {
+            t->kind = TOK_ERR;
+            s += 2;
+        }
+        else if (is_operator(*s))
+        {
+            int twice = s[1] == s[0];
+            switch (*s)
+            {
+            case '|':
+                t->kind = twice ? TOK_OR : TOK_PIPE;
+                break;
+            case '&':
+                t->kind = twice ? TOK_AND : TOK_BG;
+                break;
+            case '>':
+                t->kind = twice ? TOK_APPEND : TOK_OUT;
+                break;
+            case '<':
+                t->kind = TOK_IN;
+                twice = 0;
+                break;
+            default:
+                t->kind = TOK_SEQ;
+                twice = 0;
+                break;
+            }
+            s += twice ? 2 : 1;
+        }
+        else
+        {
+            t->kind = TOK_WORD;
+            t->text = words;
+            s = read_word(s, &words);
+            if (!s)
+            {
+                fprintf(stderr, "Error: comilla sin cerrar\n");
+                return NULL;
+            }
+            continue;
+        }
+        t->text = (char*)op_text[t->kind];
+    }
+}
+
+static void syntax_error(const t_token* t)
+{
+    fprintf(stderr, "Error de sintaxis cerca de '%s'\n", t->text);
+}
+
+static t_simple_command* parse_command(t_ast* ast, t_token** cur)
+{
+    // Primero se cuentan las palabras para pedir argv de una vez
+    int words = 0;
+    for (t_token* t = *cur; t->kind == TOK_WORD || is_redir(t->kind); t = t->next)
+    {
+        if (is_redir(t->kind))
+        {
+            t = t->next;
+            if (t->kind != TOK_WORD)
+            {
+                break;
+            }
+        }
+        else
+        {
+            words++;
+        }
+    }
+
+    t_simple_command* c = ast_alloc(ast, sizeof(t_simple_command));
+    char** argv = ast_alloc(ast, ((size_t)words + 1) * sizeof(char*));
+    if (!c || !argv)
+    {
+        return NULL;
+    }
+    c->argv = argv;
+
+    t_redir** redirs = &c->redirs;
+    while (1)
+    {
+        t_token* t = *cur;
+        if (t->kind == TOK_WORD)
+        {
+            argv[c->argc++] = t->text;
+            *cur = t->next;
+        }
+        else if (is_redir(t->kind))
+        {
+            if (t->next->kind != TOK_WORD)
+            {
+                syntax_error(t->next);
+                return NULL;
+            }
+            t_redir* r = ast_alloc(ast, sizeof(t_redir));
+            if (!r)
+            {
+                return NULL;
+            }
+            r->kind = t->kind;
+            r->path = t->next->text;
+            *redirs = r;
+            redirs = &r->next;
+            *cur = t->next->next;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (c->argc == 0 && !c->redirs)
+    {
+        syntax_error(*cur);
+        return NULL;
+    }
+    return c;
+}
+
+static t_pipeline* parse_pipeline(t_ast* ast, t_token** cur)
+{
+    t_pipeline* p = ast_alloc(ast, sizeof(t_pipeline));
+    if (!p || !(p->commands = parse_command(ast, cur)))
+    {
+        return NULL;
+    }
+    p->count = 1;
+    p->op = TOK_END;
+
+    t_simple_command* last = p->commands;
+    while ((*cur)->kind == TOK_PIPE)
+    {
+        *cur = (*cur)->next;
+        if (!(last->next = parse_command(ast, cur)))
+        {
+            return NULL;
+        }
+        last = last->next;
+        p->count++;
+    }
+    return p;
+}
+
+static t_and_or* parse_and_or(t_ast* ast, t_token** cur)
+{
+    t_and_or* a = ast_alloc(ast, sizeof(t_and_or));
+    if (!a || !(a->pipelines = parse_pipeline(ast, cur)))
+    {
+        return NULL;
+    }
+
+    t_pipeline* last = a->pipelines;
+    while ((*cur)->kind == TOK_AND || (*cur)->kind == TOK_OR)
+    {
+        last->op = (*cur)->kind;
+        *cur = (*cur)->next;
+        if (!(last->next = parse_pipeline(ast, cur)))
+        {
+            return NULL;
+        }
+        last = last->next;
+    }
+    return a;
+}
+
+t_ast* parseLine(const char* line)
+{
+    t_ast* ast = calloc(1, sizeof(t_ast));
+    if (!ast)
+    {
+        return NULL;
+    }
+    t_token* cur = tokenize(line, ast);
+    if (!cur)
+    {
+        freeAst(ast);
+        return NULL;
+    }
+
+    t_and_or** tail = &ast->list;
+    while (cur->kind != TOK_END)
+    {
+        t_and_or* a = parse_and_or(ast, &cur);
+        if (!a)
+        {
+            freeAst(ast);
+            return NULL;
+        }
+        *tail = a;
+        tail = &a->next;
+
+        // Despues de un and_or solo puede venir un separador o el fin de linea
+        if (cur->kind == TOK_BG || cur->kind == TOK_SEQ)
+        {
+            a->background = cur->kind == TOK_BG;
+            cur = cur->next;
+        }
+    }
+    return ast;
+}
+
+const char* tokenText(t_token_kind kind)
+{
+    return op_text[kind];
+}
+
+void freeAst(t_ast* ast)
+{
+    if (!ast)
+    {
+        return;
+    }
+    while (ast->arena)
+    {
+        struct s_ast_chunk* next = ast->arena->next;
+        free(ast->arena);
+        ast->arena = next;
+    }
+    free(ast);
+}
@@ -0,0 +1,198 @@
+#include "path_hash.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @struct s_hash_entry
+ * @brief Comando guardado: nombre, ruta absoluta y cantidad de usos.
+ */
+struct s_hash_entry
+{
+    char* name;
+    char* path;
+    int hits;
+    struct s_hash_entry* next;
+};
+
+static struct s_hash_entry* buckets[PATH_HASH_BUCKETS];
+static char* hashed_path = NULL; // PATH con el que se lleno la tabla
+
+static unsigned int hash_name(const char* name)
+{
+    unsigned int h = 2166136261u;
+    for (; *name; name++)
+    {
+        h = (h ^ (unsigned char)*name) * 16777619u;
+    }
+    return h & (PATH_HASH_BUCKETS - 1);
+}
+
+static struct s_hash_entry** find_entry(const char* name)
+{
+    struct s_hash_entry** e = &buckets[hash_name(name)];
+    while (*e && strcmp((*e)->name, name) != 0)
+    {
+        e = &(*e)->next;
+    }
+    return e;
+}
+
+void clearCommandHash(void)
+{
+    for (int i = 0; i < PATH_HASH_BUCKETS; i++)
+    {
+        while (buckets[i])
+        {
+            struct s_hash_entry* next = buckets[i]->next;
+            free(buckets[i]->name);
+            free(buckets[i]->path);
+            free(buckets[i]);
+            buckets[i] = next;
+        }
+    }
+}
+
+void forgetCommand(const char* name)
+{
+    struct s_hash_entry** e = find_entry(name);
+    if (*e)
+    {
+        struct s_hash_entry* dead = *e;
+        *e = dead->next;
+        free(dead->name);
+        free(dead->path);
+        free(dead);
+    }
+}
+
+// Recorre el PATH como execvp: el primer archivo regular ejecutable gana
+static int search_path(const char* path, const char* name, char* found, size_t len)
+{
+    const char* dir = path;
+    while (1)
+    {
+        const char* end = strchr(dir, ':');
+        size_t dir_len = end ? (size_t)(end - dir) : strlen(dir);
+        struct stat st;
+
+        // Un elemento vacio es el directorio actual
+        int n = dir_len ? snprintf(found, len, "%.*s/%s", (int)dir_len, dir, name) : snprintf(found, len, "%s", name);
+        if (n > 0 && (size_t)n < len && stat(found, &st) == 0 && S_ISREG(st.st_mode) && access(found, X_OK) == 0)
+        {
+            return 1;
+        }
+        if (!end)
+        {
+            return 0;
+        }
+        dir = end + 1;
+    }
+}
+
+const char* resolveCommand(const char* name)
+{
+    if (strchr(name, '/'))
+    {
+        return name;
+    }
+
+    // Con otro PATH las rutas guardadas pueden no ser las que corresponden
+    const char* path = getenv("PATH");
+    if (!path)
+    {
+        path = DEFAULT_PATH;
+    }
+    if (!hashed_path || strcmp(hashed_path, path) != 0)
+    {
+        clearCommandHash();
+        free(hashed_path);
+        hashed_path = strdup(path);
+    }
+
+    struct s_hash_entry** e = find_entry(name);
+    if (*e)
+    {
+        (*e)->hits++;
+        return (*e)->path;
+    }
+
+    static char found[PATH_MAX];
+    if (!search_path(path, name, found, sizeof(found)))
+    {
+        return NULL;
+    }
+    if (found[0] != '/')
+    {
+        return found; // Depende del directorio actual: no se guarda
+    }
+
+    struct s_hash_entry* entry = malloc(sizeof(*entry));
+    if (!entry)
+    {
+        return found;
+    }
+    entry->name = strdup(name);
+    entry->path = strdup(found);
+    if (!entry->name || !entry->path)
+    {
+        free(entry->name);
+        free(entry->path);
+        free(entry);
+        return found;
+    }
+    entry->hits = 1;
+    entry->next = NULL;
+    *e = entry;
+    return entry->path;
+}
+
+void hashCommand(char* args[])
+{
+    if (args[1] && strcmp(args[1], "-r") == 0)
+    {
+        clearCommandHash();
+        return;
+    }
+
+    if (args[1])
+    {
+        for (int i = 1; args[i] != NULL; i++)
+        {
+            // Se guarda sin contar un uso
+            const char* path = resolveCommand(args[i]);
+            struct s_hash_entry** e = find_entry(args[i]);
+            if (!path)
+            {
+                fprintf(stderr, "hash: %s: no encontrado\n", args[i]);
+            }
+            else if (*e)
+            {
+                (*e)->hits--;
+            }
+        }
+        return;
+    }
+
+    int empty = 1;
+    for (int i = 0; i < PATH_HASH_BUCKETS; i++)
+    {
+        for (struct s_hash_entry* e = buckets[i]; e; e = e->next)
+        {
+            if (empty)
+            {
+                printf("usos\tcomando\n");
+                empty = 0;
+            }
+            printf("%4d\t%s\n", e->hits, e->path);
+        }
+    }
+    if (empty)
+    {
+        printf("hash: tabla vacia\n");
+    }
+}
@@ -1,32 +1,76 @@
 #include "process.h"
 
-void externProgram(char** args)
+extern char** environ;
+
+pid_t launchProgram(char* const args[], const t_launch* opts)
 {
-    pid_t pid = fork(); // Creación del proceso hijo
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t defaults;
+    sigset_t mask;
+    short flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
 
-    if (pid < 0)
+    // Lo que la shell ignora (o ignora por un momento, como SIGTTOU) no se hereda
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGQUIT);
+    sigaddset(&defaults, SIGTSTP);
+    sigaddset(&defaults, SIGTTIN);
+    sigaddset(&defaults, SIGTTOU);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    sigemptyset(&mask);
+    posix_spawnattr_setsigmask(&attr, &mask);
+
+    if (opts)
     {
-        // Error al crear el proceso
-        perror("Error al crear el proceso");
-        return;
+        if (opts->in_fd >= 0 && opts->in_fd != STDIN_FILENO)
+        {
+            posix_spawn_file_actions_adddup2(&actions, opts->in_fd, STDIN_FILENO);
+        }
+        if (opts->out_fd >= 0 && opts->out_fd != STDOUT_FILENO)
+        {
+            posix_spawn_file_actions_adddup2(&actions, opts->out_fd, STDOUT_FILENO);
+        }
+        if (opts->err_fd >= 0 && opts->err_fd != STDERR_FILENO)
+        {
+            posix_spawn_file_actions_adddup2(&actions, opts->err_fd, STDERR_FILENO);
+        }
+        if (opts->pgid >= 0)
+        {
+            flags |= POSIX_SPAWN_SETPGROUP;
+            posix_spawnattr_setpgroup(&attr, opts->pgid);
+        }
     }
+    posix_spawnattr_setflags(&attr, flags);
 
-    if (pid == 0)
+    pid_t pid;
+    int err = ENOENT;
+    const char* path = resolveCommand(args[0]);
+    if (path)
+    {
+        err = posix_spawn(&pid, path, &actions, &attr, args, environ);
+    }
+    if (err == ENOENT && path && path != args[0])
     {
-        // Proceso hijo
-        setup_signal_handlers();
-        printf("\n");
-        if (execvp(args[0], args) == -1)
+        // El ejecutable se movio o se borro desde que se guardo la ruta
+        forgetCommand(args[0]);
+        path = resolveCommand(args[0]);
+        if (path)
         {
-            perror("Error al ejecutar el programa");
-            exit(EXIT_FAILURE);
+            err = posix_spawn(&pid, path, &actions, &attr, args, environ);
         }
     }
 
-    else
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+    if (err != 0)
     {
-        // Proceso padre
-        int child_status;
-        waitpid(pid, &child_status, 0); // Esperar a que termine el hijo
+        errno = err;
+        return -1;
     }
+    return pid;
 }
@@ -1,22 +1,5 @@
 #include "shell.h"
 
-pthread_mutex_t jobIDMutex = PTHREAD_MUTEX_INITIALIZER;
-
-int jobID = 0;
-
-void runBackground(char* args[MAX_ARGS], int i)
-{
-    args[i - 1] = NULL;
-
-    // Proteccion de recurso compartido
-    pthread_mutex_lock(&jobIDMutex);
-    jobID++;
-    int currentJobID = jobID;
-    pthread_mutex_unlock(&jobIDMutex);
-
-    backgroundProcess(args, currentJobID);
-}
-
 void executeBatchFile(const char* filename)
 {
     FILE* file = fopen(filename, "r");
@@ -30,30 +13,8 @@ void executeBatchFile(const char* filename)
     while (fgets(command, sizeof(command), file) != NULL)
     {
         command[strcspn(command, "\n")] = 0; // Eliminar el salto de línea
-
-        // Separar el comando en argumentos
-        char* args[MAX_ARGS];
-        char* token = strtok(command, " ");
-        int i = 0;
-
-        while (token != NULL && i < MAX_ARGS - 1)
-        {
-            args[i++] = token;
-            token = strtok(NULL, " ");
-        }
-        args[i] = NULL; // Terminar el array de argumentos
-
-        // Verificar si el último argumento es '&' para ejecuctar en segundo plano
-        if (i > 0 && strcmp(args[i - 1], "&") == 0)
-        {
-            runBackground(args, i);
-        }
-
-        // Para programas externos en primer plano
-        else
-        {
-            externProgram(args);
-        }
+        executeLine(command);
+        reapJobs(); // Los trabajos en segundo plano no quedan como zombies
     }
 
     fclose(file);
@@ -105,33 +66,52 @@ char* getPrompt()
     return dir;
 }
 
-void strip_quotes(char* arg)
-{
-    size_t len = strlen(arg);
-    if (len > 1 && ((arg[0] == '"' && arg[len - 1] == '"') || (arg[0] == '\'' && arg[len - 1] == '\'')))
-    {
-        // Si el argumento comienza y termina con la misma comilla, las elimina
-        memmove(arg, arg + 1, len - 2);
-        arg[len - 2] = '\0';
-    }
-}
-
 void runShell(int argc, char* argv[])
 {
     char command[MAX_CMD_LENGTH];
 
-    if (argc > 1)
+    initJobControl();
+
+    // -j N: las lineas del archivo corren en paralelo, hasta N a la vez
+    int max_jobs = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:")) != -1)
+    {
+        if (opt == 'j' && atoi(optarg) > 0)
+        {
+            max_jobs = atoi(optarg);
+        }
+        else
+        {
+            fprintf(stderr, "Uso: %s [-j N] [archivo]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (max_jobs > 0 && optind >= argc)
+    {
+        fprintf(stderr, "Error: -j necesita un archivo de comandos\n");
+        exit(EXIT_FAILURE);
+    }
+    else if (max_jobs > 0)
     {
-        executeBatchFile(argv[1]);
+        if (executeBatchParallel(argv[optind], max_jobs) != 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (optind < argc)
+    {
+        executeBatchFile(argv[optind]);
     }
     else
     {
         while (1)
         {
+            reapJobs(); // Avisa los trabajos que terminaron antes del prompt
             char* prompt = getPrompt();
             printf("%s ", prompt);
             fflush(stdout);
-            bool redir = false;
 
             if (fgets(command, sizeof(command), stdin) == NULL)
             {
@@ -141,70 +121,7 @@ void runShell(int argc, char* argv[])
 
             command[strcspn(command, "\n")] = 0; // Eliminar el salto de línea
 
-            if (strcmp(command, "quit") == 0)
-            {
-                exit(0);
-            }
-
-            char* args[MAX_ARGS] = {0};
-            char* token = strtok(command, " ");
-            int i = 0;
-            int pipe_count = 0;
-
-            while (token != NULL && i < MAX_ARGS - 1)
-            {
-                strip_quotes(token); // Eliminar las comillas si las tiene
-                if (strcmp(token, "<") == 0 || strcmp(token, ">") == 0)
-                {
-                    redir = true;
-                }
-
-                if (strcmp(token, "|") == 0)
-                {
-                    // Validar que el pipe no sea redundante
-                    if (i == 0 || (i > 0 && args[i - 1] == NULL))
-                    {
-                        fprintf(stderr, "Error: Pipe mal formado\n");
-                        i = 0; // Resetea el comando
-                        break;
-                    }
-                    pipe_count++;
-                }
-                args[i++] = token;
-                token = strtok(NULL, " ");
-            }
-
-            if (i == 0)
-            {
-                continue; // Comando vacío o inválido
-            }
-
-            args[i] = NULL; // Termina el arreglo de argumentos
-
-            if (redir)
-            {
-                execCommandWithRedirection(args);
-            }
-            else
-            {
-                // Controla si hay pipes
-                if (pipe_count > 0)
-                {
-                    execPipes(args, pipe_count);
-                    continue;
-                }
-                // Controla si es un proceso en segundo plano
-                else if (i > 0 && strcmp(args[i - 1], "&") == 0)
-                {
-                    args[i - 1] = NULL; // Elimina '&' del arreglo de argumentos
-                    runBackground(args, i);
-                }
-                // Ejecuta proceso en primer plano
-                else
-                {
-                    execCommand(args);
-                }
-            }
+            executeLine(command);
         }
     }
 }
@@ -1,12 +1,14 @@
 #include "signals.h"
 
-pid_t foreground_pid = -1; // Almacena el PID del proceso en primer plano
+volatile sig_atomic_t foreground_pid = -1; // Grupo del trabajo en primer plano
+
+volatile sig_atomic_t child_changed = 0;
 
 void sigint_handler(int sig)
 {
     if (foreground_pid > 0)
     {
-        kill(foreground_pid, SIGINT);
+        kill(-foreground_pid, SIGINT);
     }
 }
 
@@ -14,7 +16,7 @@ void sigtstp_handler(int sig)
 {
     if (foreground_pid > 0)
     {
-        kill(foreground_pid, SIGTSTP);
+        kill(-foreground_pid, SIGTSTP);
     }
 }
 
@@ -22,13 +24,27 @@ void sigquit_handler(int sig)
 {
     if (foreground_pid > 0)
     {
-        kill(foreground_pid, SIGQUIT);
+        kill(-foreground_pid, SIGQUIT);
     }
 }
 
+void sigchld_handler(int sig)
+{
+    (void)sig;
+    // Solo se marca: los hijos se recogen con reapJobs fuera del manejador
+    child_changed = 1;
+}
+
 void setup_signal_handlers()
 {
     signal(SIGINT, sigint_handler);
     signal(SIGTSTP, sigtstp_handler);
     signal(SIGQUIT, sigquit_handler);
+
+    // SA_RESTART: la lectura del prompt no se corta cuando termina un trabajo
+    struct sigaction sa;
+    sa.sa_handler = sigchld_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGCHLD, &sa, NULL);
 }
@@ -0,0 +1,609 @@
+#define _GNU_SOURCE // fstatat, openat, O_DIRECTORY
+
+#include "walker.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @struct s_walk_dir
+ * @brief Directorio pendiente de leer.
+ */
+typedef struct s_walk_dir
+{
+    struct s_walk_dir* parent; /**< Se abre relativo a su descriptor; NULL para la raiz. */
+    _Atomic int refs;          /**< La lectura propia mas los hijos que todavia no se abrieron. */
+    int fd;                    /**< Abierto mientras queden hijos por abrir, o -1. */
+    int depth;                 /**< 0 para la raiz. */
+    size_t name;               /**< Donde empieza el nombre dentro de path. */
+    size_t len;
+    char path[];
+} t_walk_dir;
+
+/**
+ * @struct s_walk_array
+ * @brief Arreglo circular de una cola; se reemplaza por uno del doble al llenarse.
+ */
+typedef struct s_walk_array
+{
+    long mask;
+    struct s_walk_array* retired; /**< Arreglos anteriores: un ladron puede estar leyendolos. */
+    _Atomic(t_walk_dir*) items[];
+} t_walk_array;
+
+/**
+ * @struct s_walk_deque
+ * @brief Cola doble de un hilo: el dueño usa `bottom`, los ladrones `top`.
+ */
+typedef struct s_walk_deque
+{
+    _Atomic long top;
+    _Atomic long bottom;
+    _Atomic(t_walk_array*) array;
+    char pad[64]; // Cada cola en su propia linea de cache
+} t_walk_deque;
+
+/**
+ * @struct s_walk_result
+ * @brief Nodo de la cola de resultados; la ruta va en el mismo bloque.
+ */
+typedef struct s_walk_result
+{
+    _Atomic(struct s_walk_result*) next;
+    char* path;
+} t_walk_result;
+
+/**
+ * @struct s_walker
+ * @brief Estado compartido por los hilos de un recorrido.
+ */
+typedef struct s_walker
+{
+    const t_walk_options* options;
+    int glob;      /**< El patron tiene comodines: se usa fnmatch. */
+    int threads;
+    _Atomic long pending; /**< Directorios agregados que todavia no se terminaron de leer. */
+    _Atomic int running;  /**< Hilos que no terminaron. */
+    _Atomic unsigned int epoch; /**< Cambia con cada directorio agregado. */
+    _Atomic int idle;           /**< Hilos dormidos esperando trabajo. */
+    _Atomic long results;       /**< Resultados terminados de agregar. */
+    _Atomic int waiting;        /**< El consumidor esta dormido esperando resultados. */
+    pthread_mutex_t lock;
+    pthread_cond_t work;  /**< Hay un directorio nuevo o no queda ninguno. */
+    pthread_cond_t ready; /**< Hay un resultado nuevo o terminaron todos los hilos. */
+    _Atomic(t_walk_result*) head; /**< Ultimo nodo agregado (productores). */
+    t_walk_result* tail;          /**< Proximo a sacar (consumidor). */
+    t_walk_result stub;
+    t_walk_deque deques[WALK_MAX_THREADS];
+} t_walker;
+
+/**
+ * @struct s_walk_worker
+ * @brief Argumento de cada hilo.
+ */
+typedef struct s_walk_worker
+{
+    t_walker* walker;
+    int index;
+    pthread_t thread;
+} t_walk_worker;
+
+static t_walk_array* array_new(long size, t_walk_array* retired)
+{
+    t_walk_array* a = malloc(sizeof(t_walk_array) + (size_t)size * sizeof(t_walk_dir*));
+    if (a)
+    {
+        a->mask = size - 1;
+        a->retired = retired;
+    }
+    return a;
+}
+
+// Solo el dueño agrega. Devuelve -1 si no se pudo agrandar la cola.
+static int deque_push(t_walk_deque* q, t_walk_dir* dir)
+{
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    t_walk_array* a = atomic_load_explicit(&q->array, memory_order_relaxed);
+
+    if (b - t > a->mask)
+    {
+        // El arreglo viejo queda colgado del nuevo hasta el final del recorrido
+        t_walk_array* grown = array_new((a->mask + 1) * 2, a);
+        if (!grown)
+        {
+            return -1;
+        }
+        for (long i = t; i < b; i++)
+        {
+            atomic_store_explicit(&grown->items[i & grown->mask],
+                                  atomic_load_explicit(&a->items[i & a->mask], memory_order_relaxed),
+                                  memory_order_relaxed);
+        }
+        atomic_store_explicit(&q->array, grown, memory_order_release);
+        a = grown;
+    }
+
+    // release: un ladron que ve el nuevo bottom ve tambien el directorio
+    atomic_store_explicit(&a->items[b & a->mask], dir, memory_order_relaxed);
+    atomic_store_explicit(&q->bottom, b + 1, memory_order_release);
+    return 0;
+}
+
+// Solo el dueño saca por abajo (lo ultimo que agrego: recorre en profundidad)
+static t_walk_dir* deque_take(t_walk_deque* q)
+{
+    long b = atomic_load_explicit(&q->bottom, memory_order_relaxed) - 1;
+    t_walk_array* a = atomic_load_explicit(&q->array, memory_order_relaxed);
+    atomic_store_explicit(&q->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&q->top, memory_order_relaxed);
+
+    t_walk_dir* dir = NULL;
+    if (t <= b)
+    {
+        dir = atomic_load_explicit(&a->items[b & a->mask], memory_order_relaxed);
+        if (t == b)
+        {
+            // Queda uno solo: se compite con los ladrones por el
+            if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1, memory_order_seq_cst,
+                                                         memory_order_relaxed))
+            {
+                dir = NULL;
+            }
+            atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+        }
+    }
+    else
+    {
+        atomic_store_explicit(&q->bottom, b + 1, memory_order_relaxed);
+    }
+    return dir;
+}
+
+// Cualquier otro hilo roba por arriba (lo mas viejo: directorios cerca de la raiz)
+static t_walk_dir* deque_steal(t_walk_deque* q)
+{
+    long t = atomic_load_explicit(&q->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&q->bottom, memory_order_acquire);
+
+    if (t >= b)
+    {
+        return NULL;
+    }
+    t_walk_array* a = atomic_load_explicit(&q->array, memory_order_acquire);
+    t_walk_dir* dir = atomic_load_explicit(&a->items[t & a->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&q->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+    {
+        return NULL; // Otro lo saco primero
+    }
+    return dir;
+}
+
+// Cola de resultados de Vyukov: cada productor hace un solo exchange
+static void result_push(t_walker* w, t_walk_result* r)
+{
+    atomic_store_explicit(&r->next, NULL, memory_order_relaxed);
+    t_walk_result* prev = atomic_exchange_explicit(&w->head, r, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, r, memory_order_release);
+}
+
+// Solo el hilo que llamo a walkTree. NULL si esta vacia o un productor esta a
+// mitad de agregar.
+static t_walk_result* result_pop(t_walker* w)
+{
+    t_walk_result* tail = w->tail;
+    t_walk_result* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &w->stub)
+    {
+        if (!next)
+        {
+            return NULL;
+        }
+        w->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next)
+    {
+        w->tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&w->head, memory_order_acquire))
+    {
+        return NULL;
+    }
+    // Se vuelve a poner el nodo fijo para poder sacar el ultimo
+    result_push(w, &w->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next)
+    {
+        w->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+static int matches(const t_walker* w, const char* name)
+{
+    return w->glob ? fnmatch(w->options->pattern, name, 0) == 0 : strstr(name, w->options->pattern) != NULL;
+}
+
+// Ruta de una entrada: directorio + '/' + nombre, en un bloque que empieza en `offset`
+static void* join_path(const t_walk_dir* dir, const char* name, size_t offset, char** path, size_t* len)
+{
+    size_t name_len = strlen(name);
+    int slash = dir->path[dir->len - 1] != '/';
+    *len = dir->len + (size_t)slash + name_len;
+
+    char* block = malloc(offset + *len + 1);
+    if (!block)
+    {
+        return NULL;
+    }
+    *path = block + offset;
+    memcpy(*path, dir->path, dir->len);
+    (*path)[dir->len] = '/';
+    memcpy(*path + dir->len + slash, name, name_len + 1);
+    return block;
+}
+
+static void wake(t_walker* w, pthread_cond_t* cond, int all)
+{
+    pthread_mutex_lock(&w->lock);
+    if (all)
+    {
+        pthread_cond_broadcast(cond);
+    }
+    else
+    {
+        pthread_cond_signal(cond);
+    }
+    pthread_mutex_unlock(&w->lock);
+}
+
+// El ultimo que suelta un directorio cierra su descriptor
+static void dir_release(t_walk_dir* dir)
+{
+    if (atomic_fetch_sub_explicit(&dir->refs, 1, memory_order_acq_rel) == 1)
+    {
+        if (dir->fd != -1)
+        {
+            close(dir->fd);
+        }
+        free(dir);
+    }
+}
+
+static void add_dir(t_walker* w, int self, t_walk_dir* parent, const char* name)
+{
+    char* path;
+    size_t len;
+    t_walk_dir* dir = join_path(parent, name, offsetof(t_walk_dir, path), &path, &len);
+    if (!dir)
+    {
+        return;
+    }
+    dir->parent = parent;
+    atomic_init(&dir->refs, 1);
+    dir->fd = -1;
+    dir->depth = parent->depth + 1;
+    dir->name = len - strlen(name);
+    dir->len = len;
+
+    // Antes de agregarlo: un ladron puede abrirlo enseguida
+    atomic_fetch_add_explicit(&parent->refs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&w->pending, 1, memory_order_relaxed);
+    if (deque_push(&w->deques[self], dir) == -1)
+    {
+        atomic_fetch_sub_explicit(&w->pending, 1, memory_order_relaxed);
+        atomic_fetch_sub_explicit(&parent->refs, 1, memory_order_relaxed);
+        free(dir);
+        return;
+    }
+
+    // seq_cst con idle_wait: o el que se duerme ve el epoch nuevo, o aca se ve
+    // que hay alguien dormido
+    atomic_fetch_add(&w->epoch, 1);
+    if (atomic_load(&w->idle) > 0)
+    {
+        wake(w, &w->work, 0);
+    }
+}
+
+static void add_result(t_walker* w, const t_walk_dir* parent, const char* name)
+{
+    char* path;
+    size_t len;
+    t_walk_result* r = join_path(parent, name, sizeof(t_walk_result), &path, &len);
+    if (r)
+    {
+        r->path = path;
+        result_push(w, r);
+        atomic_fetch_add(&w->results, 1);
+        if (atomic_load(&w->waiting))
+        {
+            wake(w, &w->ready, 0);
+        }
+    }
+}
+
+static void scan_dir(t_walker* w, int self, t_walk_dir* dir)
+{
+    // Relativo al padre, sin seguir enlaces y sin volver a resolver la ruta entera
+    int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+    int fd = dir->parent ? openat(dir->parent->fd, dir->path + dir->name, flags) : open(dir->path, flags);
+    if (dir->parent)
+    {
+        dir_release(dir->parent);
+        dir->parent = NULL;
+    }
+    if (fd == -1)
+    {
+        return; // Ignora directorios sin permisos
+    }
+
+    // readdir usa una copia: fd sigue abierto para los hijos despues de closedir
+    int stream_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    DIR* stream = stream_fd == -1 ? NULL : fdopendir(stream_fd);
+    if (!stream)
+    {
+        if (stream_fd != -1)
+        {
+            close(stream_fd);
+        }
+        close(fd);
+        return;
+    }
+    dir->fd = fd;
+
+    int max_depth = w->options->max_depth;
+    int files = max_depth < 0 || dir->depth < max_depth;    // Se miran los archivos de este nivel
+    int subdirs = max_depth < 0 || dir->depth + 1 < max_depth; // Se baja un nivel mas
+
+    struct dirent* entry;
+    while ((entry = readdir(stream)) != NULL)
+    {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+        {
+            continue;
+        }
+
+        unsigned char type = entry->d_type;
+        if (type == DT_UNKNOWN || type == DT_LNK)
+        {
+            // Un enlace se sigue solo para ver si apunta a un archivo regular
+            struct stat st;
+            if (fstatat(fd, name, &st, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) == -1)
+            {
+                continue;
+            }
+            type = S_ISREG(st.st_mode) ? DT_REG : (S_ISDIR(st.st_mode) && type == DT_UNKNOWN) ? DT_DIR : DT_UNKNOWN;
+        }
+
+        if (type == DT_DIR && subdirs)
+        {
+            add_dir(w, self, dir, name);
+        }
+        else if (type == DT_REG && files && matches(w, name))
+        {
+            add_result(w, dir, name);
+        }
+    }
+    closedir(stream);
+}
+
+// Duerme hasta que se agregue un directorio despues de `epoch` o no quede ninguno
+static void idle_wait(t_walker* w, unsigned int epoch)
+{
+    atomic_fetch_add(&w->idle, 1);
+    pthread_mutex_lock(&w->lock);
+    while (atomic_load(&w->epoch) == epoch && atomic_load(&w->pending) != 0)
+    {
+        pthread_cond_wait(&w->work, &w->lock);
+    }
+    pthread_mutex_unlock(&w->lock);
+    atomic_fetch_sub(&w->idle, 1);
+}
+
+static void* worker(void* arg)
+{
+    t_walk_worker* self = arg;
+    t_walker* w = self->walker;
+    unsigned int seed = (unsigned int)self->index * 2654435761u + 1;
+
+    while (1)
+    {
+        // Se lee antes de buscar: lo que se agregue despues no se pierde
+        unsigned int epoch = atomic_load(&w->epoch);
+        t_walk_dir* dir = deque_take(&w->deques[self->index]);
+        for (int i = 0; !dir && i < w->threads; i++)
+        {
+            // Sin trabajo propio: se intenta robar empezando por un hilo al azar
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            int victim = (int)(seed % (unsigned int)w->threads);
+            if (victim != self->index)
+            {
+                dir = deque_steal(&w->deques[victim]);
+            }
+        }
+
+        if (!dir)
+        {
+            // Se termina cuando no queda ningun directorio en ninguna cola ni leyendose
+            if (atomic_load_explicit(&w->pending, memory_order_acquire) == 0)
+            {
+                break;
+            }
+            idle_wait(w, epoch);
+            continue;
+        }
+
+        scan_dir(w, self->index, dir);
+        dir_release(dir);
+        if (atomic_fetch_sub_explicit(&w->pending, 1, memory_order_acq_rel) == 1)
+        {
+            wake(w, &w->work, 1); // Era el ultimo: todos pueden terminar
+        }
+    }
+
+    if (atomic_fetch_sub_explicit(&w->running, 1, memory_order_release) == 1)
+    {
+        wake(w, &w->ready, 0);
+    }
+    return NULL;
+}
+
+long walkTree(const char* root, const t_walk_options* options, void (*on_match)(const char* path, void* ctx),
+              void* ctx)
+{
+    // Una sola realpath: todas las rutas se arman a partir de esta
+    char* abs_root = realpath(root, NULL);
+    if (!abs_root)
+    {
+        return -1;
+    }
+    struct stat st;
+    if (stat(abs_root, &st) == -1 || !S_ISDIR(st.st_mode))
+    {
+        free(abs_root);
+        errno = ENOTDIR;
+        return -1;
+    }
+
+    t_walker* w = calloc(1, sizeof(t_walker));
+    t_walk_dir* first = malloc(sizeof(t_walk_dir) + strlen(abs_root) + 1);
+    if (!w || !first)
+    {
+        free(w);
+        free(first);
+        free(abs_root);
+        return -1;
+    }
+    first->parent = NULL;
+    atomic_init(&first->refs, 1);
+    first->fd = -1;
+    first->depth = 0;
+    first->name = 0;
+    first->len = strlen(abs_root);
+    memcpy(first->path, abs_root, first->len + 1);
+    free(abs_root);
+
+    w->options = options;
+    w->glob = strpbrk(options->pattern, "*?[") != NULL;
+    w->threads = options->threads > 0 ? options->threads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    w->threads = w->threads < 1 ? 1 : w->threads > WALK_MAX_THREADS ? WALK_MAX_THREADS : w->threads;
+    w->tail = &w->stub;
+    atomic_init(&w->head, &w->stub);
+    atomic_init(&w->stub.next, NULL);
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->work, NULL);
+    pthread_cond_init(&w->ready, NULL);
+
+    t_walk_worker workers[WALK_MAX_THREADS];
+    int started = 0;
+    for (int i = 0; i < w->threads; i++)
+    {
+        atomic_init(&w->deques[i].array, array_new(WALK_DEQUE_SIZE, NULL));
+        if (!atomic_load(&w->deques[i].array))
+        {
+            w->threads = i;
+            break;
+        }
+    }
+
+    // La raiz arranca en la cola del primer hilo; los demas se la roban de a partes
+    atomic_init(&w->pending, 1);
+    if (w->threads == 0 || deque_push(&w->deques[0], first) == -1)
+    {
+        free(first);
+        atomic_store(&w->pending, 0);
+    }
+    atomic_store(&w->running, w->threads);
+    for (int i = 0; i < w->threads; i++)
+    {
+        workers[i].walker = w;
+        workers[i].index = i;
+        if (pthread_create(&workers[i].thread, NULL, worker, &workers[i]) != 0)
+        {
+            // Los hilos que si arrancaron se reparten todo el trabajo
+            atomic_fetch_sub(&w->running, w->threads - i);
+            break;
+        }
+        started++;
+    }
+    if (started == 0)
+    {
+        // Sin hilos, el recorrido lo hace el que llamo
+        workers[0].walker = w;
+        workers[0].index = 0;
+        atomic_store(&w->running, 1);
+        worker(&workers[0]);
+    }
+
+    // Se entregan los resultados mientras los hilos siguen buscando
+    long found = 0;
+    while (1)
+    {
+        int done = atomic_load_explicit(&w->running, memory_order_acquire) == 0;
+        long results = atomic_load(&w->results);
+        t_walk_result* r;
+        while ((r = result_pop(w)) != NULL)
+        {
+            on_match(r->path, ctx);
+            found++;
+            free(r);
+        }
+        if (done)
+        {
+            break;
+        }
+
+        // Duerme hasta que un hilo termine de agregar otro resultado o terminen
+        // todos; los agregados antes de leer `results` ya se sacaron o estan
+        // detras de uno a medio agregar, que avisa al terminar
+        atomic_store(&w->waiting, 1);
+        pthread_mutex_lock(&w->lock);
+        while (atomic_load(&w->results) == results && atomic_load(&w->running) != 0)
+        {
+            pthread_cond_wait(&w->ready, &w->lock);
+        }
+        pthread_mutex_unlock(&w->lock);
+        atomic_store(&w->waiting, 0);
+    }
+
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+    }
+    for (int i = 0; i < w->threads; i++)
+    {
+        t_walk_array* a = atomic_load(&w->deques[i].array);
+        while (a)
+        {
+            t_walk_array* retired = a->retired;
+            free(a);
+            a = retired;
+        }
+    }
+    pthread_cond_destroy(&w->ready);
+    pthread_cond_destroy(&w->work);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+    return found;
+}
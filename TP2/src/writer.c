@@ -0,0 +1,61 @@
+#include "writer.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+void initWriter(t_writer* writer, int fd)
+{
+    writer->fd = fd;
+    writer->count = 0;
+    writer->error = 0;
+}
+
+void writeSlice(t_writer* writer, const char* data, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+    if (writer->count == WRITER_IOV)
+    {
+        flushWriter(writer);
+    }
+    writer->iov[writer->count].iov_base = (void*)data;
+    writer->iov[writer->count].iov_len = len;
+    writer->count++;
+}
+
+int flushWriter(t_writer* writer)
+{
+    struct iovec* iov = writer->iov;
+    int count = writer->count;
+    writer->count = 0;
+
+    while (count > 0 && writer->error == 0)
+    {
+        ssize_t n = writev(writer->fd, iov, count);
+        if (n < 0)
+        {
+            if (errno != EINTR)
+            {
+                writer->error = errno;
+            }
+            continue;
+        }
+
+        // Escritura parcial: se saltean los pedazos completos y se recorta el siguiente
+        size_t done = (size_t)n;
+        while (count > 0 && done >= iov->iov_len)
+        {
+            done -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0)
+        {
+            iov->iov_base = (char*)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
+    }
+    return writer->error == 0 ? 0 : -1;
+}
@@ -0,0 +1,17 @@
+/**
+ * @file batch_test.h
+ * @brief Pruebas de la ejecucion en paralelo de archivos de comandos.
+ *
+ * Funciones de prueba para verificar executeBatchParallel.
+ */
+
+#include <batch.h>
+#include <unity.h>
+
+/**
+ * @brief Prueba la función executeBatchParallel.
+ *
+ * Verifica que las lineas corran a la vez, que la salida quede en el orden del
+ * archivo y que se cuenten las que fallaron.
+ */
+void test_executeBatchParallel(void);
@@ -0,0 +1,47 @@
+/**
+ * @file command_test.h
+ * @brief Pruebas de la ejecucion de lineas de comandos.
+ *
+ * Funciones de prueba para verificar executeLine.
+ */
+
+#include <command.h>
+#include <unity.h>
+
+/**
+ * @brief  Bytes que atraviesan el pipeline de prueba.
+ *
+ * Mayor que el buffer de un pipe (64 KiB): con etapas secuenciales se bloquea.
+ */
+#define PIPE_TEST_BYTES 200000
+
+/**
+ * @brief Prueba los pipelines de executeLine.
+ *
+ * Verifica que las etapas corran a la vez y que la ultima escriba directo en stdout.
+ */
+void test_executeLinePipes(void);
+
+/**
+ * @brief Prueba las listas y redirecciones de executeLine.
+ *
+ * Verifica `;`, `&&` y `||`, pipes combinados con redirecciones y el estado
+ * que devuelve cada linea.
+ */
+void test_executeLineLists(void);
+
+/**
+ * @brief Prueba los trabajos en segundo plano de executeLine.
+ *
+ * Verifica que `wait` devuelva el estado del trabajo y que reapJobs recoja los
+ * que terminaron sin dejar zombies.
+ */
+void test_executeLineJobs(void);
+
+/**
+ * @brief Prueba los comandos internos.
+ *
+ * Verifica que findBuiltin encuentre cada comando de la tabla y ningun otro, y
+ * que un comando interno funcione con redirecciones y dentro de un pipeline.
+ */
+void test_builtins(void);
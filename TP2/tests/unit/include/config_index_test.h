@@ -0,0 +1,18 @@
+/**
+ * @file config_index_test.h
+ * @brief Pruebas del indice de archivos de configuracion.
+ *
+ * Funciones de prueba para verificar el indice y buscarConfig con indice.
+ */
+
+#include <config_index.h>
+#include <intern_command.h>
+#include <unity.h>
+
+/**
+ * @brief Prueba el indice persistente de buscarConfig.
+ *
+ * Verifica que el indice se guarde y se vuelva a cargar, que una segunda pasada
+ * no muestre archivos sin cambios y que avise los modificados y los borrados.
+ */
+void test_configIndex(void);
@@ -29,9 +29,20 @@ void test_changeDirectory(void);
  */
 void test_clearScreen(void);
 
+/**
+ * @brief  Argumentos del echo largo de prueba (más que WRITER_IOV).
+ */
+#define ECHO_TEST_ARGS 1000
+
+/**
+ * @brief  Largo del argumento más grande del echo de prueba.
+ */
+#define ECHO_TEST_LENGTH (1 << 20)
+
 /**
  * @brief Prueba la función echoCommand.
  *
- * Verifica que reproduzca correctamente el texto ingresado en la salida estándar.
+ * Verifica que reproduzca correctamente el texto ingresado en la salida estándar,
+ * con variables de entorno, y que no tenga límite de largo.
  */
 void test_echoCommand(void);
@@ -0,0 +1,24 @@
+/**
+ * @file parser_test.h
+ * @brief Pruebas del analisis de lineas de comandos.
+ *
+ * Funciones de prueba para verificar tokenize y parseLine.
+ */
+
+#include <parser.h>
+#include <unity.h>
+
+/**
+ * @brief Prueba la función tokenize.
+ *
+ * Verifica las comillas, los escapes, los operadores y los comentarios.
+ */
+void test_tokenize(void);
+
+/**
+ * @brief Prueba la función parseLine.
+ *
+ * Verifica la forma del arbol (listas, and_or, pipelines y redirecciones) y
+ * que los errores de sintaxis devuelvan NULL.
+ */
+void test_parseLine(void);
@@ -0,0 +1,16 @@
+/**
+ * @file path_hash_test.h
+ * @brief Pruebas de la tabla de comandos del PATH.
+ *
+ * Funciones de prueba para verificar resolveCommand y su invalidacion.
+ */
+
+#include <path_hash.h>
+#include <unity.h>
+
+/**
+ * @brief Prueba la función resolveCommand.
+ *
+ * Verifica que la ruta se guarde, que se invalide al cambiar el PATH y con `hash -r`.
+ */
+void test_resolveCommand(void);
@@ -5,7 +5,13 @@
  * Funciones de prueba para comprobar el comportamiento general del shell.
  */
 
+#include "batch_test.h"
+#include "command_test.h"
+#include "config_index_test.h"
 #include "intern_command_test.h"
+#include "parser_test.h"
+#include "path_hash_test.h"
+#include "walker_test.h"
 #include <shell.h>
 
 /**
@@ -22,13 +28,6 @@
  */
 void get_Prompt_Test(void);
 
-/**
- * @brief Prueba la función strip_quotes.
- *
- * Verifica que las comillas simples o dobles sean eliminadas correctamente de los argumentos.
- */
-void test_strip_quotes(void);
-
 /**
  * @brief Prueba la función changeSettings.
  *
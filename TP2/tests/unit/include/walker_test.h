@@ -0,0 +1,22 @@
+/**
+ * @file walker_test.h
+ * @brief Pruebas del recorrido en paralelo de directorios.
+ *
+ * Funciones de prueba para verificar walkTree.
+ */
+
+#include <unity.h>
+#include <walker.h>
+
+/**
+ * @brief  Subdirectorios por nivel del arbol de prueba grande.
+ */
+#define WALK_TEST_FANOUT 8
+
+/**
+ * @brief Prueba la función walkTree.
+ *
+ * Verifica patrones con y sin comodines, la profundidad maxima, que no entre en
+ * enlaces a directorios y que varios hilos encuentren todo en un arbol grande.
+ */
+void test_walkTree(void);
@@ -0,0 +1,64 @@
+#include "batch_test.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+void test_executeBatchParallel(void)
+{
+    char batch_path[] = "/tmp/batch_testXXXXXX";
+    int batch_fd = mkstemp(batch_path);
+    TEST_ASSERT_NOT_EQUAL(-1, batch_fd);
+
+    // La primera linea termina ultima: su salida igual tiene que ir primero
+    const char* script = "sleep 0.4; echo uno\n"
+                         "# comentario\n"
+                         "\n"
+                         "sleep 0.2 && echo dos\n"
+                         "echo tres; programa_que_no_existe\n"
+                         "sleep 0.3; echo cuatro | tr a-z A-Z\n";
+    TEST_ASSERT_EQUAL((ssize_t)strlen(script), write(batch_fd, script, strlen(script)));
+    close(batch_fd);
+
+    char out_path[] = "/tmp/batch_outXXXXXX";
+    int out_fd = mkstemp(out_path);
+    TEST_ASSERT_NOT_EQUAL(-1, out_fd);
+
+    fflush(stdout);
+    fflush(stderr);
+    int stdout_backup = dup(STDOUT_FILENO);
+    int stderr_backup = dup(STDERR_FILENO);
+    dup2(out_fd, STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDERR_FILENO);
+    close(null);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int failed = executeBatchParallel(batch_path, 4);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    dup2(stdout_backup, STDOUT_FILENO);
+    dup2(stderr_backup, STDERR_FILENO);
+    close(stdout_backup);
+    close(stderr_backup);
+
+    char buffer[256] = {0};
+    TEST_ASSERT_GREATER_THAN(0, pread(out_fd, buffer, sizeof(buffer) - 1, 0));
+    close(out_fd);
+    unlink(out_path);
+    unlink(batch_path);
+
+    // Solo falla la linea del programa que no existe (127)
+    TEST_ASSERT_EQUAL(1, failed);
+    TEST_ASSERT_EQUAL_STRING("uno\ndos\ntres\nprograma_que_no_existe: No such file or directory\nCUATRO\n", buffer);
+
+    // En serie tardaria 0.9 s
+    double seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+    TEST_ASSERT_TRUE(seconds < 0.8);
+
+    TEST_ASSERT_EQUAL(-1, executeBatchParallel("/archivo/que/no/existe", 2));
+}
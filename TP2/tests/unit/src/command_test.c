@@ -0,0 +1,138 @@
+#include "command_test.h"
+
+void test_executeLinePipes(void)
+{
+    char out_path[] = "/tmp/execpipes_testXXXXXX";
+    int out_fd = mkstemp(out_path);
+    TEST_ASSERT_NOT_EQUAL(-1, out_fd);
+
+    // La ultima etapa hereda el stdout de la shell: se redirige al archivo
+    fflush(stdout);
+    int stdout_backup = dup(STDOUT_FILENO);
+    dup2(out_fd, STDOUT_FILENO);
+
+    char line[64];
+    snprintf(line, sizeof(line), "head -c %d /dev/zero | wc -c", PIPE_TEST_BYTES);
+
+    // Si las etapas corrieran de a una, head se bloquearia con el pipe lleno
+    alarm(10);
+    int status = executeLine(line);
+    alarm(0);
+
+    dup2(stdout_backup, STDOUT_FILENO);
+    close(stdout_backup);
+    TEST_ASSERT_EQUAL(0, status);
+
+    char buffer[64] = {0};
+    TEST_ASSERT_GREATER_THAN(0, pread(out_fd, buffer, sizeof(buffer) - 1, 0));
+    TEST_ASSERT_EQUAL(PIPE_TEST_BYTES, atoi(buffer));
+    close(out_fd);
+    unlink(out_path);
+}
+
+void test_executeLineLists(void)
+{
+    char dir[] = "/tmp/executeline_testXXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+
+    char line[256];
+    char path[128];
+
+    // `&&` y `||` segun el estado del anterior; `;` corre siempre
+    snprintf(line, sizeof(line), "false && touch %s/a || touch %s/b ; true || touch %s/c", dir, dir, dir);
+    TEST_ASSERT_EQUAL(0, executeLine(line));
+    snprintf(path, sizeof(path), "%s/a", dir);
+    TEST_ASSERT_NOT_EQUAL(0, access(path, F_OK));
+    snprintf(path, sizeof(path), "%s/b", dir);
+    TEST_ASSERT_EQUAL(0, access(path, F_OK));
+    snprintf(path, sizeof(path), "%s/c", dir);
+    TEST_ASSERT_NOT_EQUAL(0, access(path, F_OK));
+
+    // Pipe y redirecciones en la misma linea, con comillas
+    snprintf(line, sizeof(line), "printf 'uno dos\\n' | tr a-z A-Z > \"%s/out\" ; echo tres >> %s/out", dir, dir);
+    TEST_ASSERT_EQUAL(0, executeLine(line));
+    snprintf(path, sizeof(path), "%s/out", dir);
+    FILE* out = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(out);
+    char buffer[64] = {0};
+    fread(buffer, 1, sizeof(buffer) - 1, out);
+    fclose(out);
+    TEST_ASSERT_EQUAL_STRING("UNO DOS\ntres\n", buffer);
+
+    // El estado es el de la ultima etapa
+    TEST_ASSERT_EQUAL(1, executeLine("true | false"));
+    TEST_ASSERT_EQUAL(127, executeLine("programa_que_no_existe 2> /dev/null"));
+    TEST_ASSERT_EQUAL(2, executeLine("| wc"));
+
+    snprintf(line, sizeof(line), "rm -r %s", dir);
+    TEST_ASSERT_EQUAL(0, executeLine(line));
+}
+
+void test_executeLineJobs(void)
+{
+    // Caso: wait devuelve el estado del trabajo y lo saca de la tabla
+    TEST_ASSERT_EQUAL(0, executeLine("sh -c 'exit 3' > /dev/null &"));
+    TEST_ASSERT_EQUAL(3, executeLine("wait %1"));
+    TEST_ASSERT_EQUAL(127, executeLine("wait %1 2> /dev/null"));
+
+    // Caso: los trabajos terminados se recogen sin bloquear y no quedan zombies
+    TEST_ASSERT_EQUAL(0, executeLine("true > /dev/null & true | true > /dev/null &"));
+    siginfo_t info;
+    alarm(10);
+    while (waitid(P_ALL, 0, &info, WEXITED | WNOHANG | WNOWAIT) == 0)
+    {
+        // Lo que haria el manejador de SIGCHLD en la shell
+        child_changed = 1;
+        reapJobs();
+        usleep(1000);
+    }
+    alarm(0);
+    TEST_ASSERT_EQUAL(ECHILD, errno);
+}
+
+void test_builtins(void)
+{
+    const char* names[] = {"cd",   "clr",          "echo",          "hash",          "jobs",
+                           "fg",   "bg",           "wait",          "quit",          "buscarconfig",
+                           "leerconfig", "buscarformato", "start_monitor", "stop_monitor", "status_monitor"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        const t_builtin* builtin = findBuiltin(names[i]);
+        TEST_ASSERT_NOT_NULL(builtin);
+        TEST_ASSERT_EQUAL_STRING(names[i], builtin->name);
+    }
+    const char* others[] = {"", "c", "ls", "cdd", "dc", "ehco", "status_monitorr", "buscarConfig"};
+    for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); i++)
+    {
+        TEST_ASSERT_NULL(findBuiltin(others[i]));
+    }
+
+    char dir[] = "/tmp/builtins_testXXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char cwd[PATH_MAX];
+    TEST_ASSERT_NOT_NULL(getcwd(cwd, sizeof(cwd)));
+
+    // Dentro de la shell con redireccion, y como etapa de un pipeline
+    char line[256];
+    snprintf(line, sizeof(line), "echo uno > %s/out ; echo dos | tr a-z A-Z >> %s/out", dir, dir);
+    TEST_ASSERT_EQUAL(0, executeLine(line));
+
+    // En un pipeline cd corre en un hijo: la shell no cambia de directorio
+    snprintf(line, sizeof(line), "cd %s | true", dir);
+    TEST_ASSERT_EQUAL(0, executeLine(line));
+    char now[PATH_MAX];
+    TEST_ASSERT_EQUAL_STRING(cwd, getcwd(now, sizeof(now)));
+
+    char path[128];
+    snprintf(path, sizeof(path), "%s/out", dir);
+    FILE* out = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL(out);
+    char buffer[64] = {0};
+    fread(buffer, 1, sizeof(buffer) - 1, out);
+    fclose(out);
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "uno"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "DOS"));
+
+    unlink(path);
+    rmdir(dir);
+}
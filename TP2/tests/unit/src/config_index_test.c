@@ -0,0 +1,103 @@
+#include "config_index_test.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void write_file(const char* dir, const char* name, const char* content)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    TEST_ASSERT_EQUAL((ssize_t)strlen(content), write(fd, content, strlen(content)));
+    close(fd);
+}
+
+// Corre buscarConfig y deja su salida en buffer
+static void run_config(const char* dir, const char* operacion, const char* indice, char* buffer, size_t size)
+{
+    char out_path[] = "/tmp/config_outXXXXXX";
+    int out_fd = mkstemp(out_path);
+    TEST_ASSERT_NOT_EQUAL(-1, out_fd);
+    unlink(out_path);
+
+    fflush(stdout);
+    int stdout_backup = dup(STDOUT_FILENO);
+    dup2(out_fd, STDOUT_FILENO);
+    buscarConfig((char*)dir, (char*)operacion, indice);
+    fflush(stdout);
+    dup2(stdout_backup, STDOUT_FILENO);
+    close(stdout_backup);
+
+    memset(buffer, 0, size);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, pread(out_fd, buffer, size - 1, 0));
+    close(out_fd);
+}
+
+void test_configIndex(void)
+{
+    char dir[] = "/tmp/config_testXXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(dir));
+    char real_dir[512];
+    TEST_ASSERT_NOT_NULL(realpath(dir, real_dir));
+    char index_path[600];
+    snprintf(index_path, sizeof(index_path), "%s/indice", real_dir);
+
+    write_file(dir, "app.json", "{\"a\": 1}");
+    write_file(dir, "red.conf", "puerto=80");
+    write_file(dir, "notas.txt", "no es config");
+    write_file(dir, "viejo.conf.bak", "tampoco");
+
+    // Sin indice se muestra todo; el contenido sale tal cual
+    char buffer[2048];
+    run_config(dir, "contenido", NULL, buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "puerto=80"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "{\"a\": 1}"));
+    TEST_ASSERT_NULL(strstr(buffer, "no es config"));
+    TEST_ASSERT_NULL(strstr(buffer, "tampoco"));
+
+    // Primera pasada con indice: todos son nuevos
+    run_config(dir, "paths", index_path, buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "app.json"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "red.conf"));
+
+    t_config_index index;
+    TEST_ASSERT_EQUAL(0, loadConfigIndex(&index, index_path));
+    char path[600];
+    snprintf(path, sizeof(path), "%s/red.conf", real_dir);
+    t_config_entry* entry = findConfigEntry(&index, path);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL(9, entry->size);
+    TEST_ASSERT_EQUAL_UINT64(hashContent("puerto=80", 9), entry->hash);
+    freeConfigIndex(&index);
+
+    // Segunda pasada: nada cambio, no se muestra ningun archivo
+    run_config(dir, "contenido", index_path, buffer, sizeof(buffer));
+    TEST_ASSERT_NULL(strstr(buffer, "puerto=80"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "2 archivos sin cambios"));
+
+    // Uno modificado y uno borrado
+    write_file(dir, "red.conf", "puerto=8080");
+    snprintf(path, sizeof(path), "%s/app.json", dir);
+    unlink(path);
+    run_config(dir, "contenido", index_path, buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "puerto=8080"));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "Eliminado: "));
+    TEST_ASSERT_NOT_NULL(strstr(buffer, "app.json"));
+
+    TEST_ASSERT_EQUAL(0, loadConfigIndex(&index, index_path));
+    TEST_ASSERT_NULL(findConfigEntry(&index, path));
+    freeConfigIndex(&index);
+
+    unlink(index_path);
+    const char* names[] = {"red.conf", "notas.txt", "viejo.conf.bak"};
+    for (int i = 0; i < 3; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
@@ -29,21 +29,64 @@ void test_clearScreen(void)
     TEST_ASSERT_TRUE(1);
 }
 
-void test_echoCommand(void)
+// Corre echoCommand con stdout en un archivo y devuelve lo que escribio
+static char* capture_echo(char* args[])
 {
-    char input[] = "Hello $HOME";
-    char expected_output[MAX_PRINT];
-    snprintf(expected_output, MAX_PRINT, "Hello %s\n", getenv("HOME"));
+    char out_path[] = "/tmp/echo_testXXXXXX";
+    int out_fd = mkstemp(out_path);
+    TEST_ASSERT_NOT_EQUAL(-1, out_fd);
+    unlink(out_path);
 
-    // Redirigir stdout para capturar la salida
-    FILE* stdout_backup = stdout;
-    char buffer[MAX_DIR_LENGTH];
-    stdout = fmemopen(buffer, sizeof(buffer), "w");
+    fflush(stdout);
+    int stdout_backup = dup(STDOUT_FILENO);
+    dup2(out_fd, STDOUT_FILENO);
+    TEST_ASSERT_EQUAL(0, echoCommand(args));
+    dup2(stdout_backup, STDOUT_FILENO);
+    close(stdout_backup);
 
-    echoCommand(input);
+    off_t size = lseek(out_fd, 0, SEEK_END);
+    char* buffer = calloc((size_t)size + 1, 1);
+    TEST_ASSERT_NOT_NULL(buffer);
+    TEST_ASSERT_EQUAL(size, pread(out_fd, buffer, (size_t)size, 0));
+    close(out_fd);
+    return buffer;
+}
 
-    fflush(stdout);
-    stdout = stdout_backup;
+void test_echoCommand(void)
+{
+    char expected_output[MAX_DIR_LENGTH + 16];
+    snprintf(expected_output, sizeof(expected_output), "Hello %s\n", getenv("HOME"));
+    char* args[] = {"echo", "Hello", "$HOME", NULL};
+    char* output = capture_echo(args);
+    TEST_ASSERT_EQUAL_STRING(expected_output, output);
+    free(output);
+
+    // Variables dentro de un argumento, '$' sueltos y espacios que se respetan
+    setenv("ECHO_TEST", "valor", 1);
+    char* mixed[] = {"echo", "a=$ECHO_TEST/x", "$", "$NO_EXISTE_ECHO", "dos  espacios", NULL};
+    output = capture_echo(mixed);
+    TEST_ASSERT_EQUAL_STRING("a=valor/x $  dos  espacios\n", output);
+    free(output);
 
-    TEST_ASSERT_EQUAL_STRING(expected_output, buffer);
+    // Sin limite de largo ni de cantidad de argumentos
+    size_t count = ECHO_TEST_ARGS;
+    char** many = calloc(count + 2, sizeof(char*));
+    char* big = malloc(ECHO_TEST_LENGTH + 1);
+    TEST_ASSERT_NOT_NULL(many);
+    TEST_ASSERT_NOT_NULL(big);
+    memset(big, 'x', ECHO_TEST_LENGTH);
+    big[ECHO_TEST_LENGTH] = '\0';
+    many[0] = "echo";
+    for (size_t i = 1; i <= count; i++)
+    {
+        many[i] = i == count / 2 ? big : "$ECHO_TEST";
+    }
+    output = capture_echo(many);
+    TEST_ASSERT_EQUAL((count - 1) * (strlen("valor") + 1) + ECHO_TEST_LENGTH + 1, strlen(output));
+    TEST_ASSERT_EQUAL(0, strncmp(output, "valor valor", 11));
+    TEST_ASSERT_EQUAL('\n', output[strlen(output) - 1]);
+    free(output);
+    free(big);
+    free(many);
+    unsetenv("ECHO_TEST");
 }
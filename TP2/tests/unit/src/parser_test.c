@@ -0,0 +1,86 @@
+#include "parser_test.h"
+
+#include <stdlib.h>
+
+void test_tokenize(void)
+{
+    t_ast* ast = calloc(1, sizeof(t_ast));
+    TEST_ASSERT_NOT_NULL(ast);
+
+    // Caso: comillas dentro de una palabra y escapes
+    t_token* t = tokenize("echo 'a  b'\"c\\\"d\" e\\ f", ast);
+    TEST_ASSERT_NOT_NULL(t);
+    TEST_ASSERT_EQUAL_STRING("echo", t->text);
+    TEST_ASSERT_EQUAL_STRING("a  bc\"d", t->next->text);
+    TEST_ASSERT_EQUAL_STRING("e f", t->next->next->text);
+    TEST_ASSERT_EQUAL(TOK_END, t->next->next->next->kind);
+
+    // Caso: operadores pegados a las palabras
+    t_token_kind kinds[] = {TOK_WORD, TOK_AND, TOK_WORD, TOK_OR, TOK_WORD, TOK_PIPE, TOK_WORD, TOK_IN, TOK_WORD,
+                            TOK_APPEND, TOK_WORD, TOK_ERR, TOK_WORD, TOK_SEQ, TOK_WORD, TOK_OUT, TOK_WORD, TOK_BG,
+                            TOK_END};
+    t = tokenize("a&&b||c|d<e>>f 2>g;h>i& # comentario", ast);
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++)
+    {
+        TEST_ASSERT_NOT_NULL(t);
+        TEST_ASSERT_EQUAL(kinds[i], t->kind);
+        t = t->next;
+    }
+
+    // Caso: comilla sin cerrar
+    TEST_ASSERT_NULL(tokenize("echo \"sin cerrar", ast));
+    TEST_ASSERT_NULL(tokenize("echo 'sin cerrar", ast));
+
+    freeAst(ast);
+}
+
+void test_parseLine(void)
+{
+    // Caso: lista con pipeline, redirecciones y segundo plano
+    t_ast* ast = parseLine("cat < in | grep x > out 2> err && echo ok || echo no ; sleep 1 &");
+    TEST_ASSERT_NOT_NULL(ast);
+
+    t_and_or* first = ast->list;
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL(0, first->background);
+
+    t_pipeline* p = first->pipelines;
+    TEST_ASSERT_EQUAL(2, p->count);
+    TEST_ASSERT_EQUAL(TOK_AND, p->op);
+    TEST_ASSERT_EQUAL_STRING("cat", p->commands->argv[0]);
+    TEST_ASSERT_NULL(p->commands->argv[1]);
+    TEST_ASSERT_EQUAL(TOK_IN, p->commands->redirs->kind);
+    TEST_ASSERT_EQUAL_STRING("in", p->commands->redirs->path);
+
+    t_simple_command* grep = p->commands->next;
+    TEST_ASSERT_EQUAL(2, grep->argc);
+    TEST_ASSERT_EQUAL_STRING("x", grep->argv[1]);
+    TEST_ASSERT_EQUAL(TOK_OUT, grep->redirs->kind);
+    TEST_ASSERT_EQUAL_STRING("out", grep->redirs->path);
+    TEST_ASSERT_EQUAL(TOK_ERR, grep->redirs->next->kind);
+    TEST_ASSERT_EQUAL_STRING("err", grep->redirs->next->path);
+
+    TEST_ASSERT_EQUAL(TOK_OR, p->next->op);
+    TEST_ASSERT_EQUAL_STRING("no", p->next->next->commands->argv[1]);
+    TEST_ASSERT_EQUAL(TOK_END, p->next->next->op);
+
+    t_and_or* second = first->next;
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL(1, second->background);
+    TEST_ASSERT_EQUAL_STRING("sleep", second->pipelines->commands->argv[0]);
+    TEST_ASSERT_NULL(second->next);
+    freeAst(ast);
+
+    // Caso: linea vacia o comentario
+    ast = parseLine("   # nada");
+    TEST_ASSERT_NOT_NULL(ast);
+    TEST_ASSERT_NULL(ast->list);
+    freeAst(ast);
+
+    // Caso: errores de sintaxis
+    TEST_ASSERT_NULL(parseLine("| wc"));
+    TEST_ASSERT_NULL(parseLine("ls |"));
+    TEST_ASSERT_NULL(parseLine("ls > "));
+    TEST_ASSERT_NULL(parseLine("ls && ; pwd"));
+    TEST_ASSERT_NULL(parseLine("; ls"));
+}
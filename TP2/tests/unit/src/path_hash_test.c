@@ -0,0 +1,38 @@
+#include "path_hash_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void test_resolveCommand(void)
+{
+    char* saved = strdup(getenv("PATH"));
+
+    // Caso: comando del PATH, la segunda busqueda sale de la tabla
+    setenv("PATH", "/nonexistent:/bin:/usr/bin", 1);
+    const char* sh = resolveCommand("sh");
+    TEST_ASSERT_NOT_NULL(sh);
+    TEST_ASSERT_EQUAL_INT('/', sh[0]);
+    TEST_ASSERT_EQUAL_STRING("/sh", strrchr(sh, '/'));
+    TEST_ASSERT_EQUAL_PTR(sh, resolveCommand("sh"));
+
+    // Caso: nombres con '/' no se buscan
+    TEST_ASSERT_EQUAL_STRING("./programa", resolveCommand("./programa"));
+
+    // Caso: comando inexistente
+    TEST_ASSERT_NULL(resolveCommand("comando_que_no_existe"));
+
+    // Caso: con otro PATH la tabla se vacia
+    setenv("PATH", "/nonexistent", 1);
+    TEST_ASSERT_NULL(resolveCommand("sh"));
+
+    // Caso: hash -r
+    setenv("PATH", saved, 1);
+    TEST_ASSERT_NOT_NULL(resolveCommand("sh"));
+    char hash[] = "hash", r[] = "-r";
+    char* args[] = {hash, r, NULL};
+    hashCommand(args);
+    TEST_ASSERT_NOT_NULL(resolveCommand("sh"));
+    forgetCommand("sh");
+
+    free(saved);
+}
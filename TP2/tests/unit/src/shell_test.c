@@ -1,20 +1,5 @@
 #include "shell_test.h"
 
-void test_strip_quotes(void)
-{
-    char test1[] = "\"test\"";
-    char test2[] = "'example'";
-    char test3[] = "no_quotes";
-
-    strip_quotes(test1);
-    strip_quotes(test2);
-    strip_quotes(test3);
-
-    TEST_ASSERT_EQUAL_STRING("test", test1);
-    TEST_ASSERT_EQUAL_STRING("example", test2);
-    TEST_ASSERT_EQUAL_STRING("no_quotes", test3);
-}
-
 void get_Prompt_Test(void)
 {
     char cwd[MAX_LENGTH];
@@ -28,8 +28,17 @@ int main(void)
     RUN_TEST(get_Prompt_Test);
     RUN_TEST(test_changeDirectory);
     RUN_TEST(test_echoCommand);
-    RUN_TEST(test_strip_quotes);
     RUN_TEST(test_clearScreen);
     RUN_TEST(test_changeSettings);
+    RUN_TEST(test_executeLinePipes);
+    RUN_TEST(test_executeLineLists);
+    RUN_TEST(test_executeLineJobs);
+    RUN_TEST(test_builtins);
+    RUN_TEST(test_resolveCommand);
+    RUN_TEST(test_executeBatchParallel);
+    RUN_TEST(test_tokenize);
+    RUN_TEST(test_parseLine);
+    RUN_TEST(test_walkTree);
+    RUN_TEST(test_configIndex);
     return UNITY_END();
 }
@@ -0,0 +1,104 @@
+#include "walker_test.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Resultados y rutas que no son absolutas. Se revisan despues de walkTree:
+// un TEST_ASSERT no puede fallar dentro del recorrido
+typedef struct s_walk_count
+{
+    long found;
+    long relative;
+} t_walk_count;
+
+static void count_match(const char* path, void* ctx)
+{
+    t_walk_count* count = ctx;
+    count->relative += path[0] != '/';
+    count->found++;
+}
+
+static void touch(const char* dir, const char* name)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    TEST_ASSERT_NOT_EQUAL(-1, fd);
+    close(fd);
+}
+
+// Arbol de WALK_TEST_FANOUT^depth directorios, con un .conf y un .txt en cada uno
+static long build_tree(const char* dir, int depth)
+{
+    touch(dir, "app.conf");
+    touch(dir, "notas.txt");
+    long dirs = 1;
+    for (int i = 0; depth > 0 && i < WALK_TEST_FANOUT; i++)
+    {
+        char sub[512];
+        snprintf(sub, sizeof(sub), "%s/d%d", dir, i);
+        TEST_ASSERT_EQUAL(0, mkdir(sub, 0755));
+        dirs += build_tree(sub, depth - 1);
+    }
+    return dirs;
+}
+
+void test_walkTree(void)
+{
+    char root[] = "/tmp/walker_testXXXXXX";
+    TEST_ASSERT_NOT_NULL(mkdtemp(root));
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/a", root);
+    TEST_ASSERT_EQUAL(0, mkdir(path, 0755));
+    touch(path, "red.conf");
+    touch(path, "red.conf.bak");
+    touch(root, "app.json");
+
+    // Un enlace a la raiz no se sigue: no hay ciclo ni resultados repetidos
+    snprintf(path, sizeof(path), "%s/a/vuelta", root);
+    TEST_ASSERT_EQUAL(0, symlink(root, path));
+
+    t_walk_count count = {0, 0};
+    t_walk_options options = {".conf", -1, 4};
+    TEST_ASSERT_EQUAL(2, walkTree(root, &options, count_match, &count));
+    TEST_ASSERT_EQUAL(2, count.found);
+
+    // Con comodines el nombre tiene que coincidir entero
+    options.pattern = "*.conf";
+    TEST_ASSERT_EQUAL(1, walkTree(root, &options, count_match, &count));
+    options.pattern = "app.[jy]*";
+    TEST_ASSERT_EQUAL(1, walkTree(root, &options, count_match, &count));
+
+    // Profundidad 1: solo la raiz
+    options.pattern = "conf";
+    options.max_depth = 1;
+    TEST_ASSERT_EQUAL(0, walkTree(root, &options, count_match, &count));
+    options.max_depth = 2;
+    TEST_ASSERT_EQUAL(2, walkTree(root, &options, count_match, &count));
+
+    // Arbol grande: todos los hilos tienen que robar trabajo para terminar
+    snprintf(path, sizeof(path), "%s/arbol", root);
+    TEST_ASSERT_EQUAL(0, mkdir(path, 0755));
+    long dirs = build_tree(path, 3);
+    options.pattern = "*.conf";
+    options.max_depth = -1;
+    for (int threads = 1; threads <= 8; threads *= 2)
+    {
+        options.threads = threads;
+        count.found = 0;
+        TEST_ASSERT_EQUAL(dirs + 1, walkTree(root, &options, count_match, &count));
+        TEST_ASSERT_EQUAL(dirs + 1, count.found);
+    }
+    TEST_ASSERT_EQUAL(0, count.relative);
+
+    TEST_ASSERT_EQUAL(-1, walkTree("/directorio/que/no/existe", &options, count_match, &count));
+
+    char command[600];
+    snprintf(command, sizeof(command), "rm -rf %s", root);
+    TEST_ASSERT_EQUAL(0, system(command));
+}
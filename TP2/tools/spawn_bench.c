@@ -0,0 +1,112 @@
+/**
+ * @file spawn_bench.c
+ * @brief Comandos por segundo lanzando con fork + execvp contra launchProgram (posix_spawn).
+ *
+ * Uso: spawn_bench [comandos] [MB de heap] [programa]
+ *
+ * Emula el modo batch de la shell: lanza el programa (por defecto true) y
+ * espera a que termine, una vez por comando. fork copia las tablas de paginas
+ * del padre, asi que su costo crece con la memoria de la shell: antes de medir
+ * se reservan y escriben los MB indicados. Se imprime una linea CSV por forma
+ * de lanzar: posix_spawnp recorre el PATH en cada comando, launchProgram usa
+ * la tabla de comandos (path_hash.h).
+ */
+
+#include "process.h"
+
+#include <time.h>
+
+/** Comandos por defecto de cada corrida. */
+#define BENCH_COMMANDS 2000
+/** MB de heap escrito por defecto. */
+#define BENCH_HEAP_MB 256
+
+/**
+ * @struct s_launcher
+ * @brief Forma de lanzar un comando: devuelve el PID del hijo o -1.
+ */
+struct s_launcher
+{
+    const char* name;
+    pid_t (*launch)(char* const args[]);
+};
+
+// El camino que usaba la shell antes de launchProgram
+static pid_t fork_launch(char* const args[])
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execvp(args[0], args);
+        _exit(127);
+    }
+    return pid;
+}
+
+extern char** environ;
+
+static pid_t spawnp_launch(char* const args[])
+{
+    pid_t pid;
+    return posix_spawnp(&pid, args[0], NULL, NULL, args, environ) == 0 ? pid : -1;
+}
+
+static pid_t spawn_launch(char* const args[])
+{
+    return launchProgram(args, NULL);
+}
+
+static const struct s_launcher launchers[] = {
+    {"fork", fork_launch},
+    {"posix_spawnp", spawnp_launch},
+    {"launchProgram", spawn_launch},
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[])
+{
+    int commands = argc > 1 ? atoi(argv[1]) : BENCH_COMMANDS;
+    size_t heap_mb = argc > 2 ? strtoul(argv[2], NULL, 10) : BENCH_HEAP_MB;
+    char* args[] = {argc > 3 ? argv[3] : "true", NULL};
+
+    // Memoria escrita (con tablas de paginas) que fork tiene que copiar
+    size_t heap_len = heap_mb << 20;
+    char* heap = NULL;
+    if (heap_len > 0)
+    {
+        heap = malloc(heap_len);
+        if (!heap)
+        {
+            perror("malloc");
+            return EXIT_FAILURE;
+        }
+        memset(heap, 1, heap_len);
+    }
+
+    printf("launcher,commands,heap_mb,seconds,commands_per_sec\n");
+    for (size_t l = 0; l < sizeof(launchers) / sizeof(launchers[0]); l++)
+    {
+        double start = now();
+        for (int i = 0; i < commands; i++)
+        {
+            pid_t pid = launchers[l].launch(args);
+            if (pid < 0)
+            {
+                perror(launchers[l].name);
+                return EXIT_FAILURE;
+            }
+            waitpid(pid, NULL, 0);
+        }
+        double seconds = now() - start;
+        printf("%s,%d,%zu,%.3f,%.0f\n", launchers[l].name, commands, heap_mb, seconds, commands / seconds);
+    }
+
+    free(heap);
+    return EXIT_SUCCESS;
+}
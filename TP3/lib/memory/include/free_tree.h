@@ -0,0 +1,74 @@
+/**
+ * @file free_tree.h
+ * @brief Arbol rojo-negro de bloques libres ordenado por (tamano, direccion).
+ *
+ * Los nodos viven en el area de datos del bloque libre, despues de los enlaces
+ * de la lista de libres: palabras 2 a 5 (izquierdo, derecho, padre, y el
+ * bloque de menor direccion del subarbol con el color en su bit bajo).
+ * Permite Best Fit con una busqueda O(log n), First Fit (el libre de menor
+ * direccion que alcanza) tambien en O(log n) gracias a ese minimo, y Worst Fit
+ * con el maximo, que se mantiene al insertar y quitar para leerlo en O(1).
+ * Cada heap (uno por nodo NUMA) tiene su propio arbol.
+ */
+
+#pragma once
+
+#include <memory.h>
+
+/**
+ * @struct s_free_tree
+ * @brief Raiz del arbol y su mayor bloque.
+ */
+typedef struct s_free_tree
+{
+    t_block root;
+    t_block max; /**< Nodo de mas a la derecha, NULL si el arbol esta vacio */
+} t_free_tree;
+
+/**
+ * @brief Inserta un bloque libre en el arbol.
+ *
+ * El tamano del bloque no puede cambiar mientras este en el arbol.
+ *
+ * @param tree Arbol.
+ * @param b Bloque libre (fuera del arbol).
+ */
+void tree_insert(t_free_tree* tree, t_block b);
+
+/**
+ * @brief Quita un bloque libre del arbol.
+ *
+ * @param tree Arbol.
+ * @param b Bloque que esta en el arbol.
+ */
+void tree_remove(t_free_tree* tree, t_block b);
+
+/**
+ * @brief Busca el menor bloque con al menos el tamano pedido.
+ *
+ * Entre bloques del mismo tamano devuelve el de menor direccion.
+ *
+ * @param tree Arbol.
+ * @param size Tamano minimo.
+ * @return t_block Bloque encontrado, o NULL si ninguno alcanza.
+ */
+t_block tree_lower_bound(const t_free_tree* tree, size_t size);
+
+/**
+ * @brief Busca el bloque de menor direccion con al menos el tamano pedido.
+ *
+ * Es el que encuentra un recorrido del heap en orden de direcciones.
+ *
+ * @param tree Arbol.
+ * @param size Tamano minimo.
+ * @return t_block Bloque encontrado, o NULL si ninguno alcanza.
+ */
+t_block tree_first_fit(const t_free_tree* tree, size_t size);
+
+/**
+ * @brief Devuelve el mayor bloque libre en O(1).
+ *
+ * @param tree Arbol.
+ * @return t_block Bloque de mayor tamano, o NULL si el arbol esta vacio.
+ */
+t_block tree_max(const t_free_tree* tree);
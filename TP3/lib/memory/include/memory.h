@@ -4,11 +4,14 @@
  *
  * Biblioteca que define funciones de asignacion de memoria dinamica
  * y gestion de bloques para crear un asignador de memoria personalizado.
+ * Las funciones publicas toman un lock global, por lo que se pueden usar
+ * desde varios hilos.
  */
 
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -17,15 +20,22 @@
 #include <time.h>
 #include <unistd.h>
 
+/** Alineacion de los punteros que devuelve malloc (la de max_align_t). */
+#define MALLOC_ALIGN 16
+/** Mayor pedido que se acepta; los mayores fallan con ENOMEM antes de alinear. */
+#define MAX_REQUEST (SIZE_MAX / 2)
+
 /**
- * @brief Macro para alinear una cantidad de bytes al siguiente multiplo de 8.
+ * @brief Macro para alinear una cantidad de bytes al siguiente multiplo de MALLOC_ALIGN.
  *
  * @param x Cantidad de bytes a alinear.
  */
-#define align(x) (((x) == 0) ? 8 : (((((x) - 1) >> 3) << 3) + 8))
+#define align(x) (((x) == 0) ? MALLOC_ALIGN : (((((x) - 1) >> 4) << 4) + MALLOC_ALIGN))
 
-/** Tamano minimo de un bloque de memoria. */
-#define BLOCK_SIZE 40
+/** Tamano de la cabecera de un bloque (etiqueta del anterior + cabecera propia). */
+#define BLOCK_SIZE 16
+/** Tamano minimo del area de datos: un bloque libre guarda ahi sus enlaces y su nodo del arbol. */
+#define MIN_DATA 48
 /** Tamano de pagina en memoria. */
 #define PAGESIZE 4096
 /** Politica de asignacion First Fit. */
@@ -34,23 +44,106 @@
 #define BEST_FIT 1
 /** Politica de asignacion Worst Fit. */
 #define WORST_FIT 2
-/** Tamano del bloque de inicio de datos. */
-#define DATA_START 1
+/** Pedidos de este tamano o mayores reciben un mapeo propio (mmap directo). */
+#define MMAP_THRESHOLD (128 * 1024)
+/** Tamano (y alineacion, potencia de 2) de cada arena para los bloques chicos. */
+#define ARENA_SIZE (256 * 1024)
+
+/** Umbral por defecto para devolver al sistema la cola libre de una arena. */
+#define TRIM_THRESHOLD (128 * 1024)
+
+/** Tamano de una pagina grande (chunk de arenas en el modo de paginas grandes). */
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+/** Variable de entorno que activa las paginas grandes al cargar la libreria. */
+#define HUGE_PAGES_ENV "MEMORY_HUGE_PAGES"
+
+/** Modo de depuracion: canario despues de los bytes pedidos, verificado en free. */
+#define DEBUG_CANARY 0x1
+/** Modo de depuracion: pagina sin permisos despues de cada bloque con mapeo propio. */
+#define DEBUG_GUARD 0x2
+/** Modo de depuracion: los bloques liberados esperan en cuarentena antes de reutilizarse. */
+#define DEBUG_QUARANTINE 0x4
+/** Variable de entorno con los flags de depuracion al cargar la libreria. */
+#define DEBUG_ENV "MEMORY_DEBUG_FLAGS"
+
+/** Tamano por defecto de los chunks de un scope (scope_create(0)). */
+#define SCOPE_CHUNK_SIZE (64 * 1024)
+
+/** Nodos NUMA con heap propio; un nodo mayor usa el heap de (nodo % MEM_NUMA_NODES). */
+#define MEM_NUMA_NODES 8
+
+/** Cantidad de clases de tamano en las estadisticas (potencias de 2 desde 16 bytes). */
+#define MEM_SIZE_CLASSES 16
+/** Log2 del limite inferior de la primera clase de tamano de las estadisticas. */
+#define MEM_CLASS_SHIFT 4
+
+/** Flag de bloque libre (bit bajo del tamano). */
+#define BLOCK_FREE 0x1
+/** Flag de bloque con mapeo propio. */
+#define BLOCK_MAPPED 0x2
+/** Flag de bloque con trailer de depuracion (ver set_debug_flags). */
+#define BLOCK_DEBUG 0x4
+/** Mascara de los bits de flags dentro de una etiqueta. */
+#define BLOCK_FLAGS ((size_t)0x7)
 
 /**
  * @struct s_block
- * @brief Representa un bloque de memoria del heap.
+ * @brief Cabecera de un bloque de memoria del heap.
+ *
+ * Cada etiqueta guarda el tamano del area de datos con los flags empaquetados
+ * en los bits bajos. La etiqueta del bloque fisicamente anterior (su footer)
+ * queda justo antes de la propia, de modo que ambos vecinos se encuentran en
+ * O(1) sin listas enlazadas.
  */
 struct s_block
 {
-    size_t size;           /**< Tamano del bloque de datos. */
-    struct s_block* next;  /**< Puntero al siguiente bloque en la lista enlazada. */
-    struct s_block* prev;  /**< Puntero al bloque anterior en la lista enlazada. */
-    int free;              /**< Indicador de si el bloque esta libre (1) o ocupado (0). */
-    void* ptr;             /**< Puntero a la direccion de los datos almacenados. */
-    char data[DATA_START]; /**< Area donde comienzan los datos del bloque. */
+    size_t prev_foot; /**< Footer del bloque anterior: tamano | flags (0 al inicio de la arena). */
+    size_t head;      /**< Tamano del area de datos | flags (0 en el epilogo de la arena). */
+    char data[];      /**< Area donde comienzan los datos del bloque. */
 };
 
+/**
+ * @struct s_arena
+ * @brief Mapeo pedido al sistema que contiene bloques contiguos.
+ *
+ * Despues de la cabecera vienen los bloques y al final un epilogo (cabecera
+ * con head 0). Las arenas de bloques chicos se alinean a ARENA_SIZE para
+ * encontrarlas desde cualquier bloque; un bloque con mapeo propio ocupa solo
+ * su arena. Cada arena pertenece al heap de un nodo NUMA: sus bloques libres
+ * vuelven a ese heap aunque los libere un hilo de otro nodo.
+ */
+struct s_arena
+{
+    struct s_arena* next; /**< Siguiente arena. */
+    struct s_arena* prev; /**< Arena anterior. */
+    size_t size;          /**< Largo total del mapeo. */
+    char* fresh;          /**< Desde aca hasta el epilogo la arena nunca se escribio (vale cero). */
+    int node;             /**< Nodo NUMA del heap al que pertenece. */
+    int chunk;            /**< Flags de paginas grandes (0: mapeo comun, ver set_huge_pages). */
+};
+
+/** Tamano de la cabecera de una arena (multiplo de MALLOC_ALIGN). */
+#define ARENA_HEADER ((sizeof(struct s_arena) + MALLOC_ALIGN - 1) & ~(size_t)(MALLOC_ALIGN - 1))
+
+/** Tamano del area de datos de un bloque. */
+#define block_size(b) ((b)->head & ~BLOCK_FLAGS)
+/** Indica si el bloque esta libre. */
+#define block_is_free(b) (((b)->head & BLOCK_FREE) != 0)
+/** Indica si el bloque tiene un mapeo propio. */
+#define block_is_mapped(b) (((b)->head & BLOCK_MAPPED) != 0)
+/** Bloque fisicamente siguiente. */
+#define next_block(b) ((struct s_block*)((b)->data + block_size(b)))
+/** Indica si el bloque fisicamente anterior esta libre. */
+#define prev_is_free(b) (((b)->prev_foot & BLOCK_FREE) != 0)
+/** Bloque fisicamente anterior (solo valido si existe, ver prev_foot). */
+#define prev_block(b) ((struct s_block*)((char*)(b) - ((b)->prev_foot & ~BLOCK_FLAGS) - BLOCK_SIZE))
+/** Arena de bloques chicos que contiene al bloque (no aplica a mapeos propios). */
+#define arena_of(b) ((struct s_arena*)((uintptr_t)(b) & ~(uintptr_t)(ARENA_SIZE - 1)))
+/** Primer bloque de una arena. */
+#define arena_first(a) ((struct s_block*)((char*)(a) + ARENA_HEADER))
+/** Indica si el bloque es el epilogo que cierra una arena. */
+#define is_epilogue(b) ((b)->head == 0)
+
 /**
  * @struct s_log_entry
  * @brief Entrada de registro para operaciones de memoria.
@@ -64,12 +157,49 @@ typedef struct s_log_entry
     unsigned int counter;     /**< Numero de operacion consecutiva */
 } t_log_entry;
 
+/**
+ * @struct s_mem_stats
+ * @brief Estadisticas de ocupacion del heap.
+ *
+ * Se mantienen en cada operacion, sin recorrer el heap. La clase k agrupa los
+ * bloques con tamano en [2^(k+4), 2^(k+5)); la primera incluye tambien a los
+ * menores y la ultima acumula todos los mayores.
+ */
+typedef struct s_mem_stats
+{
+    size_t used_bytes;                         /**< Bytes de datos en bloques ocupados */
+    size_t free_bytes;                         /**< Bytes de datos en bloques libres */
+    size_t used_blocks;                        /**< Cantidad de bloques ocupados */
+    size_t free_blocks;                        /**< Cantidad de bloques libres */
+    size_t used_by_class[MEM_SIZE_CLASSES];    /**< Bloques ocupados por clase de tamano */
+    size_t free_by_class[MEM_SIZE_CLASSES];    /**< Bloques libres por clase de tamano */
+    size_t largest_free;                       /**< Tamano del mayor bloque libre */
+    double fragmentation;                      /**< Fragmentacion externa: 1 - largest_free / free_bytes */
+    size_t arena_count;                        /**< Arenas de bloques chicos */
+    size_t mapped_blocks;                      /**< Bloques con mapeo propio */
+    size_t mapped_bytes;                       /**< Bytes pedidos al sistema (arenas y mapeos propios) */
+    size_t released_bytes;                     /**< Bytes devueltos con madvise desde el inicio */
+    size_t slab_used_bytes;                    /**< Bytes de objetos ocupados en slabs (incluidos en used_bytes) */
+    size_t slab_bytes;                         /**< Bytes habilitados en la region de slabs */
+    size_t numa_nodes;                         /**< Nodos NUMA en linea (1 si no hay NUMA) */
+    size_t remote_frees;                       /**< free() de bloques de arenas de otro nodo */
+    size_t huge_bytes;                         /**< Bytes mapeados con paginas grandes (hugetlb o THP aceptado) */
+    size_t hugetlb_bytes;                      /**< Parte de huge_bytes reservada con MAP_HUGETLB */
+    size_t huge_pool_bytes;                    /**< Arenas sin usar de los chunks (mapeadas, fuera de mapped_bytes) */
+} t_mem_stats;
+
 /** Tipo de puntero para un bloque de memoria. */
 typedef struct s_block* t_block;
 
+/** Tipo de puntero para una arena. */
+typedef struct s_arena* t_arena;
+
+/** Tipo de puntero para un scope de asignaciones (ver scope_create). */
+typedef struct s_scope* t_scope;
+
 /** Variables globales externas */
 extern t_log_entry* log_head; /**< Puntero a la cabeza de los logs */
-extern t_block base;          /**< Puntero al primer bloque de memoria */
+extern t_arena arenas;        /**< Lista de arenas y mapeos propios del heap */
 extern int registro_malloc;   /**< Contador de llamadas a malloc */
 extern int registro_free;     /**< Contador de llamadas a free */
 extern int registro_calloc;   /**< Contador de llamadas a calloc */
@@ -78,6 +208,8 @@ extern int registro_realloc;  /**< Contador de llamadas a realloc */
 /**
  * @brief Obtiene el bloque que contiene una direccion de memoria dada.
  *
+ * La cabecera esta justo antes de los datos, asi que no se recorre el heap.
+ *
  * @param p Puntero a la direccion de datos.
  * @return t_block Puntero al bloque de memoria correspondiente.
  */
@@ -86,6 +218,9 @@ t_block get_block(void* p);
 /**
  * @brief Verifica si una direccion de memoria es valida.
  *
+ * La direccion tiene que caer dentro de una arena y la cabecera del bloque
+ * tiene que coincidir con su etiqueta de frontera.
+ *
  * @param p Direccion de memoria a verificar.
  * @return int Retorna 1 si la direccion es valida, 0 en caso contrario.
  */
@@ -94,33 +229,46 @@ int valid_addr(void* p);
 /**
  * @brief Encuentra un bloque libre que tenga al menos el tamano solicitado.
  *
- * @param last Puntero al ultimo bloque.
+ * First Fit devuelve el libre de menor direccion que alcanza, como un
+ * recorrido del heap en orden. Best Fit busca en el arbol por tamano el menor
+ * bloque que alcanza, en O(log n), y Worst Fit lee su maximo, que el arbol
+ * mantiene, en O(1).
+ *
  * @param size Tamano solicitado.
  * @return t_block Puntero al bloque encontrado, o NULL si no se encuentra ninguno.
  */
-t_block find_block(t_block* last, size_t size);
+t_block find_block(size_t size);
 
 /**
  * @brief Expande el heap para crear un nuevo bloque de memoria.
  *
- * @param last Ultimo bloque del heap.
+ * Los pedidos menores a MMAP_THRESHOLD se ubican al inicio de una arena nueva
+ * de ARENA_SIZE bytes y el resto de la arena queda como bloque libre. Los
+ * pedidos mayores reciben un mapeo propio redondeado a paginas.
+ *
  * @param s Tamano del nuevo bloque.
- * @return t_block Puntero al nuevo bloque creado.
+ * @return t_block Puntero al nuevo bloque creado (ocupado).
  */
-t_block extend_heap(t_block last, size_t s);
+t_block extend_heap(size_t s);
 
 /**
  * @brief Divide un bloque de memoria en dos, si el tamano solicitado es menor que el bloque disponible.
  *
- * @param b Bloque a dividir.
+ * El sobrante queda como bloque libre, fusionado con su vecino siguiente si
+ * tambien lo estaba.
+ *
+ * @param b Bloque ocupado a dividir.
  * @param s Tamano del nuevo bloque.
  */
 void split_block(t_block b, size_t s);
 
 /**
- * @brief Fusiona un bloque libre con su siguiente bloque si tambien esta libre.
+ * @brief Fusiona un bloque libre con sus vecinos fisicos si tambien estan libres.
+ *
+ * Usa las etiquetas de frontera, por lo que cuesta O(1). Los vecinos se quitan
+ * de la lista de libres; el bloque resultante no se inserta.
  *
- * @param b Bloque a fusionar.
+ * @param b Bloque a fusionar (marcado libre y fuera de la lista de libres).
  * @return t_block Puntero al bloque fusionado.
  */
 t_block fusion(t_block b);
@@ -136,6 +284,9 @@ void copy_block(t_block src, t_block dst);
 /**
  * @brief Asigna un bloque de memoria del tamano solicitado.
  *
+ * Los pedidos de hasta SLAB_MAX bytes salen de la capa de slabs (si esta
+ * activada); el resto, de las arenas o de un mapeo propio.
+ *
  * @param size Tamano en bytes del bloque a asignar.
  * @return void* Puntero al area de datos asignada.
  */
@@ -151,6 +302,10 @@ void free(void* p);
 /**
  * @brief Asigna un bloque de memoria para un numero de elementos, inicializandolo a cero.
  *
+ * Devuelve NULL si number * size desborda. Solo limpia la parte del bloque que
+ * ya fue escrita alguna vez: un mapeo propio recien creado y la cola nunca
+ * usada de una arena ya valen cero, asi que sus paginas no se tocan.
+ *
  * @param number Numero de elementos.
  * @param size Tamano de cada elemento.
  * @return void* Puntero al area de datos asignada e inicializada.
@@ -160,12 +315,69 @@ void* calloc(size_t number, size_t size);
 /**
  * @brief Cambia el tamano de un bloque de memoria previamente asignado.
  *
+ * Achica en el lugar devolviendo el sobrante al heap, crece en el lugar
+ * absorbiendo el bloque siguiente si esta libre (incluida la cola de la arena)
+ * y usa mremap() para los bloques con mapeo propio. Solo copia cuando nada de
+ * eso alcanza.
+ *
  * @param p Puntero al area de datos a redimensionar.
  * @param size Nuevo tamano en bytes.
  * @return void* Puntero al area de datos redimensionada.
  */
 void* realloc(void* p, size_t size);
 
+/**
+ * @brief Asigna memoria con los datos alineados a una potencia de 2.
+ *
+ * @param memptr Donde se guarda el puntero asignado (no se toca si falla).
+ * @param alignment Alineacion: potencia de 2 y multiplo de sizeof(void*).
+ * @param size Tamano en bytes.
+ * @return int 0 si se asigno, EINVAL si la alineacion no es valida o ENOMEM.
+ */
+int posix_memalign(void** memptr, size_t alignment, size_t size);
+
+/**
+ * @brief Asigna memoria alineada (C11).
+ *
+ * @param alignment Alineacion: potencia de 2.
+ * @param size Tamano en bytes.
+ * @return void* Puntero alineado, o NULL con errno en EINVAL o ENOMEM.
+ */
+void* aligned_alloc(size_t alignment, size_t size);
+
+/**
+ * @brief Asigna memoria alineada (interfaz historica, igual a aligned_alloc).
+ *
+ * @param alignment Alineacion: potencia de 2.
+ * @param size Tamano en bytes.
+ * @return void* Puntero alineado, o NULL si falla.
+ */
+void* memalign(size_t alignment, size_t size);
+
+/**
+ * @brief Asigna memoria alineada a pagina.
+ *
+ * @param size Tamano en bytes.
+ * @return void* Puntero alineado a PAGESIZE, o NULL si falla.
+ */
+void* valloc(size_t size);
+
+/**
+ * @brief Como valloc, pero redondea el tamano a paginas enteras.
+ *
+ * @param size Tamano en bytes.
+ * @return void* Puntero alineado a PAGESIZE, o NULL si falla.
+ */
+void* pvalloc(size_t size);
+
+/**
+ * @brief Bytes utilizables del bloque asignado.
+ *
+ * @param ptr Puntero devuelto por el asignador (o NULL).
+ * @return size_t Tamano util, mayor o igual al pedido; 0 para NULL o punteros ajenos.
+ */
+size_t malloc_usable_size(void* ptr);
+
 /**
  * @brief Verifica el estado del heap y detecta bloques libres consecutivos.
  *
@@ -190,11 +402,195 @@ void malloc_control(int mode);
  */
 void set_method(int m);
 
+/**
+ * @brief Activa o desactiva la capa de slabs para los pedidos chicos.
+ *
+ * Activada por defecto: los pedidos de hasta SLAB_MAX bytes se sirven desde
+ * slabs de una pagina sin cabecera por objeto (ver slab.h). Desactivarla no
+ * afecta a los objetos ya asignados, que se liberan igual.
+ *
+ * @param enabled 1 para usar slabs, 0 para ir siempre a las arenas.
+ */
+void set_slab_enabled(int enabled);
+
+/**
+ * @brief Fija el nodo NUMA del hilo que llama.
+ *
+ * Por defecto cada pedido usa el heap del nodo en el que corre el hilo
+ * (getcpu). Fijarlo sirve para emular varios nodos en una maquina sin NUMA.
+ *
+ * @param node Nodo a usar, o -1 para volver a consultar getcpu.
+ */
+void set_numa_node(int node);
+
+/**
+ * @brief Activa las paginas grandes para heaps grandes.
+ *
+ * Las arenas nuevas salen de chunks de HUGE_PAGE_SIZE alineados: primero se
+ * intenta MAP_HUGETLB y si no hay paginas reservadas se usa
+ * madvise(MADV_HUGEPAGE); si tampoco hay THP quedan paginas comunes. Las arenas
+ * de un chunk no se liberan de a partes (partirian la pagina grande): vuelven
+ * a un pool y malloc_trim() desmapea los chunks que quedan enteros sin usar.
+ * Los mapeos propios de HUGE_PAGE_SIZE o mas reciben MADV_HUGEPAGE.
+ *
+ * @param enabled 1 para activar, 0 para volver a mapeos comunes.
+ */
+void set_huge_pages(int enabled);
+
+/**
+ * @brief Activa los chequeos del modo de depuracion.
+ *
+ * Solo existe si la libreria se compilo con MEMORY_DEBUG; sin esa opcion los
+ * chequeos no se compilan y el allocator no paga nada por ellos. Cada bloque
+ * pedido con la depuracion activa lleva al final un canario y el tamano pedido:
+ * free verifica el canario (desbordes), la etiqueta de frontera (cabecera
+ * pisada) y detecta el doble free. DEBUG_GUARD agrega una pagina sin permisos
+ * despues de los bloques con mapeo propio. DEBUG_QUARANTINE llena los bloques
+ * liberados con un patron y demora su reutilizacion: al salir de la cuarentena
+ * se verifica que nadie los haya escrito. Cualquier flag implica
+ * DEBUG_CANARY; los slabs no se usan mientras la depuracion esta activa.
+ *
+ * @param flags Combinacion de DEBUG_CANARY, DEBUG_GUARD y DEBUG_QUARANTINE; 0 apaga
+ *              la depuracion y vacia la cuarentena.
+ * @return int 0 si se aplico, -1 si la libreria no tiene modo de depuracion.
+ */
+int set_debug_flags(int flags);
+
+/**
+ * @brief Reemplaza el reporte de errores del heap.
+ *
+ * Por defecto los errores detectados en una operacion se escriben en stderr y
+ * abortan el proceso; los de check_heap_all() solo se escriben. El manejador se
+ * llama con el lock del heap tomado: no puede pedir ni liberar memoria.
+ *
+ * @param handler Funcion que recibe la descripcion y el puntero afectado, o NULL
+ *                para volver al reporte por defecto.
+ */
+void set_debug_handler(void (*handler)(const char* error, void* ptr));
+
+/**
+ * @brief Recorre el heap completo y verifica su consistencia.
+ *
+ * Revisa la lista de arenas, las etiquetas de frontera de cada bloque, que no
+ * queden libres contiguos sin fusionar, que las listas de libres de cada nodo
+ * tengan exactamente los bloques libres y que las estadisticas coincidan con el
+ * recorrido. Con la depuracion compilada tambien verifica los canarios y el
+ * patron de los bloques en cuarentena. No aborta: reporta cada error.
+ *
+ * @return int Cantidad de errores encontrados (0: heap consistente).
+ */
+int check_heap_all(void);
+
+/**
+ * @brief Configura cuando free() devuelve memoria al sistema.
+ *
+ * Cuando la cola libre de una arena acumula al menos `bytes` escritos, sus
+ * paginas se liberan con madvise(MADV_DONTNEED). Una arena que queda vacia se
+ * desmapea, salvo una que se conserva de repuesto. Con (size_t)-1 free() no
+ * devuelve nada y solo queda malloc_trim().
+ *
+ * @param bytes Umbral en bytes (por defecto TRIM_THRESHOLD).
+ */
+void set_trim_threshold(size_t bytes);
+
+/**
+ * @brief Devuelve al sistema toda la memoria libre posible, como malloc_trim(3).
+ *
+ * Desmapea las arenas vacias y libera con madvise las paginas enteras de cada
+ * bloque libre, incluidos los huecos interiores, y las paginas de slabs vacios.
+ *
+ * @param pad Bytes que se conservan residentes al inicio de la cola de cada arena.
+ * @return int 1 si se devolvio memoria, 0 si no habia nada para liberar.
+ */
+int malloc_trim(size_t pad);
+
 /**
  * @brief Imprime el uso actual de memoria (bloques ocupados y libres).
  */
 void memory_usage();
 
+/**
+ * @brief Copia las estadisticas actuales del heap.
+ *
+ * @param st Estructura donde se guardan las estadisticas.
+ */
+void memory_stats(t_mem_stats* st);
+
+/**
+ * @brief Exporta las estadisticas del heap como un objeto JSON.
+ *
+ * No asigna memoria: escribe en el buffer del llamador.
+ *
+ * @param buf Buffer de destino.
+ * @param len Tamano del buffer.
+ * @return int Largo del texto generado (como snprintf); si es >= len se trunco.
+ */
+int memory_stats_json(char* buf, size_t len);
+
+/**
+ * @brief Exporta las estadisticas del heap en el formato de texto de Prometheus.
+ *
+ * No asigna memoria: escribe en el buffer del llamador.
+ *
+ * @param buf Buffer de destino.
+ * @param len Tamano del buffer.
+ * @return int Largo del texto generado (como snprintf); si es >= len se trunco.
+ */
+int memory_stats_prometheus(char* buf, size_t len);
+
+/**
+ * @brief Crea un scope para asignaciones que se liberan todas juntas.
+ *
+ * Un scope sirve pedidos chicos avanzando un puntero dentro de chunks pedidos
+ * con malloc: los objetos no llevan cabecera ni pasan por las listas de
+ * libres, y no se liberan de a uno sino con scope_reset() o scope_destroy().
+ * Pensado para los datos que viven lo que dura un pedido. No es thread-safe:
+ * cada hilo usa sus propios scopes.
+ *
+ * @param chunk_size Tamano de cada chunk, o 0 para SCOPE_CHUNK_SIZE.
+ * @return t_scope El scope, o NULL si no hay memoria.
+ */
+t_scope scope_create(size_t chunk_size);
+
+/**
+ * @brief Reserva memoria dentro de un scope.
+ *
+ * Los pedidos de mas de un cuarto del chunk reciben un chunk propio para no
+ * desperdiciar el resto del chunk actual.
+ *
+ * @param scope Scope del que se asigna.
+ * @param size Bytes pedidos.
+ * @return void* Memoria alineada a MALLOC_ALIGN, o NULL si no hay memoria.
+ */
+void* scope_alloc(t_scope scope, size_t size);
+
+/**
+ * @brief Libera todo lo asignado en un scope y lo deja listo para reusar.
+ *
+ * Devuelve al heap todos los chunks menos el primero, en O(chunks).
+ *
+ * @param scope Scope a vaciar.
+ */
+void scope_reset(t_scope scope);
+
+/**
+ * @brief Libera un scope y todo lo asignado en el.
+ *
+ * @param scope Scope a destruir (puede ser NULL).
+ */
+void scope_destroy(t_scope scope);
+
+/**
+ * @brief Activa o desactiva el registro de operaciones en log_head.
+ *
+ * Activado por defecto. Cada entrada ocupa una pagina propia, asi que
+ * conviene desactivarlo al medir rendimiento o memoria residente.
+ *
+ * @param enabled 1 para registrar cada operacion, 0 para no registrar.
+ * @return int Estado anterior, para restaurarlo.
+ */
+int set_log_enabled(int enabled);
+
 /**
  * @brief Agrega una entrada de log para una operacion de memoria.
  *
@@ -0,0 +1,80 @@
+/**
+ * @file profile.h
+ * @brief Perfilado muestreado de asignaciones por punto de llamada.
+ *
+ * Se toma una muestra cada `rate` bytes asignados: cada muestra guarda el
+ * backtrace del pedido en una tabla de hash de puntos de llamada, con la
+ * cantidad de muestras y los bytes que representan. Al terminar el proceso la
+ * tabla se vuelca como texto ordenada por bytes. Pensado para usarse con la
+ * libreria cargada por LD_PRELOAD en programas que no se pueden recompilar.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Variable de entorno con los bytes entre muestras (0 o ausente: desactivado). */
+#define PROFILE_ENV "MEMORY_PROFILE_RATE"
+/** Variable de entorno con la ruta del volcado (ausente: stderr). Se le agrega ".<pid>". */
+#define PROFILE_FILE_ENV "MEMORY_PROFILE_FILE"
+/** Maximo de marcos de pila que se guardan por punto de llamada. */
+#define PROFILE_DEPTH 16
+/** Capacidad de la tabla de puntos de llamada (potencia de 2). */
+#define PROFILE_SITES 4096
+
+/**
+ * @brief Activa o desactiva el muestreo.
+ *
+ * La primera activacion reserva la tabla con mmap. Cambiar el intervalo no
+ * borra las muestras tomadas.
+ *
+ * @param rate Bytes asignados entre muestras; 0 desactiva el muestreo.
+ * @return int 0 si se aplico, -1 si no se pudo reservar la tabla.
+ */
+int profile_set_rate(size_t rate);
+
+/**
+ * @brief Bytes entre muestras configurados.
+ *
+ * @return size_t Intervalo actual, 0 si el muestreo esta desactivado.
+ */
+size_t profile_get_rate(void);
+
+/**
+ * @brief Cuenta un pedido y, si le toca, registra su punto de llamada.
+ *
+ * La llaman malloc, calloc, realloc y las variantes alineadas sin el lock del
+ * heap tomado. Los pedidos hechos mientras se toma el backtrace no se cuentan.
+ *
+ * @param size Tamano pedido por el usuario.
+ */
+void profile_sample(size_t size);
+
+/**
+ * @brief Borra las muestras acumuladas.
+ */
+void profile_reset(void);
+
+/**
+ * @brief Vuelca los puntos de llamada ordenados por bytes.
+ *
+ * @param fd Descriptor donde escribir.
+ * @return int Cantidad de puntos de llamada volcados, o -1 si no hay tabla.
+ */
+int profile_dump(int fd);
+
+/**
+ * @brief Toma el lock del perfilador antes de un fork.
+ */
+void profile_fork_prepare(void);
+
+/**
+ * @brief Libera el lock del perfilador en el padre despues de un fork.
+ */
+void profile_fork_parent(void);
+
+/**
+ * @brief Libera el lock en el hijo y descarta las muestras heredadas.
+ */
+void profile_fork_child(void);
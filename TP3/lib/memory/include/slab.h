@@ -0,0 +1,98 @@
+/**
+ * @file slab.h
+ * @brief Capa de slabs para objetos chicos de tamano fijo.
+ *
+ * Los pedidos de hasta SLAB_MAX bytes se sirven desde slabs de una pagina,
+ * cada uno dedicado a una clase de tamano. El slab lleva al inicio un mapa de
+ * bits con los objetos libres y los objetos no tienen cabecera propia. Todos
+ * los slabs viven en una region virtual reservada, de modo que saber si una
+ * direccion es de un slab es una comparacion de rango y el slab dueno se
+ * obtiene enmascarando la direccion a la pagina.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Mayor tamano que se sirve desde los slabs. */
+#define SLAB_MAX 512
+/** Cantidad de clases de tamano de los slabs. */
+#define SLAB_CLASSES 16
+/** Tamano de cada slab (una pagina). */
+#define SLAB_SIZE 4096
+/** Palabras de 64 bits del mapa de libres (alcanza para la clase de 16 bytes). */
+#define SLAB_MAP_WORDS 4
+/** Espacio virtual reservado para todos los slabs. */
+#define SLAB_REGION_SIZE ((size_t)1 << 30)
+/** Cantidad de bytes que se habilitan de la region en cada crecimiento. */
+#define SLAB_COMMIT (64 * 1024)
+
+/**
+ * @struct s_slab
+ * @brief Cabecera al inicio de cada pagina de slab.
+ */
+struct s_slab
+{
+    struct s_slab* next;            /**< Siguiente slab parcial de la clase (o pagina vacia). */
+    struct s_slab* prev;            /**< Slab parcial anterior de la clase. */
+    uint16_t size;                  /**< Tamano de los objetos. */
+    uint16_t count;                 /**< Objetos que entran en el slab. */
+    uint16_t nfree;                 /**< Objetos libres. */
+    uint16_t cls;                   /**< Clase de tamano. */
+    uint64_t map[SLAB_MAP_WORDS];   /**< Bit en 1: objeto libre. */
+};
+
+/** Tipo de puntero para un slab. */
+typedef struct s_slab* t_slab;
+
+/** Desplazamiento del primer objeto dentro del slab. */
+#define SLAB_HEADER ((sizeof(struct s_slab) + 15) & ~(size_t)15)
+
+/**
+ * @brief Asigna un objeto de la clase que corresponde al tamano pedido.
+ *
+ * @param size Tamano pedido (1 a SLAB_MAX).
+ * @return void* Objeto asignado, o NULL si la region de slabs se agoto.
+ */
+void* slab_alloc(size_t size);
+
+/**
+ * @brief Libera un objeto de un slab.
+ *
+ * Ignora direcciones que no son el inicio de un objeto ocupado.
+ *
+ * @param p Direccion del objeto (debe cumplir slab_owns()).
+ * @return size_t Tamano del objeto liberado, o 0 si la direccion no era valida.
+ */
+size_t slab_free(void* p);
+
+/**
+ * @brief Indica si una direccion pertenece a la region de slabs.
+ *
+ * @param p Direccion a consultar.
+ * @return int 1 si la direccion cae dentro de un slab, 0 en caso contrario.
+ */
+int slab_owns(const void* p);
+
+/**
+ * @brief Tamano util del objeto que contiene la direccion.
+ *
+ * @param p Direccion del objeto (debe cumplir slab_owns()).
+ * @return size_t Tamano de la clase del objeto.
+ */
+size_t slab_usable_size(const void* p);
+
+/**
+ * @brief Devuelve al sistema las paginas de los slabs vacios.
+ *
+ * @return size_t Bytes liberados con madvise.
+ */
+size_t slab_trim(void);
+
+/**
+ * @brief Bytes de la region de slabs habilitados hasta el momento.
+ *
+ * @return size_t Bytes con permiso de escritura dentro de la region.
+ */
+size_t slab_committed(void);
@@ -0,0 +1,187 @@
+/**
+ * @file trace.h
+ * @brief Captura binaria de las operaciones de memoria y lectura para replay.
+ *
+ * El trace es un archivo con la cabecera TRACE_MAGIC seguida de la version y
+ * de un registro por operacion. Cada registro guarda el codigo de operacion
+ * en un byte y luego varints (LEB128) con el delta de tiempo en nanosegundos,
+ * el tamano y los ids de direccion que correspondan a la operacion.
+ *
+ * Un proceso que captura y hace fork sigue capturando, y el hijo escribe en
+ * su propio archivo, `<ruta>.<pid>`, que empieza vacio: los bloques heredados
+ * no tienen id ahi. Vale tambien para la version LD_PRELOAD con
+ * MEMORY_TRACE_FILE, donde cada proceso del servicio deja su trace.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Firma al inicio de todo archivo de trace. */
+#define TRACE_MAGIC "MTRC"
+/** Largo de la firma. */
+#define TRACE_MAGIC_LEN 4
+/** Version del formato de registros. */
+#define TRACE_VERSION 1
+/** Tamano del buffer de escritura antes de volcarlo al archivo. */
+#define TRACE_BUFFER_SIZE 65536
+/** Maximo de bytes que ocupa un varint de 64 bits. */
+#define TRACE_VARINT_MAX 10
+/** Variable de entorno que activa la captura al cargar la libreria. */
+#define TRACE_ENV "MEMORY_TRACE_FILE"
+/** Largo maximo de la ruta del trace. */
+#define TRACE_PATH_MAX 4096
+
+/** Operacion malloc: tamano e id del resultado. */
+#define TRACE_MALLOC 0
+/** Operacion free: id de la direccion liberada. */
+#define TRACE_FREE 1
+/** Operacion calloc: tamano total e id del resultado. */
+#define TRACE_CALLOC 2
+/** Operacion realloc: id de entrada, tamano e id del resultado. */
+#define TRACE_REALLOC 3
+
+/**
+ * @struct s_trace_record
+ * @brief Registro decodificado de un trace.
+ *
+ * Los ids valen 0 cuando la direccion es NULL o no fue asignada mientras
+ * la captura estaba activa.
+ */
+typedef struct s_trace_record
+{
+    uint8_t op;        /**< TRACE_MALLOC, TRACE_FREE, TRACE_CALLOC o TRACE_REALLOC */
+    uint64_t delta_ns; /**< Nanosegundos desde el registro anterior */
+    uint64_t size;     /**< Tamano pedido (0 para free) */
+    uint64_t id_in;    /**< Id de la direccion recibida (free y realloc) */
+    uint64_t id_out;   /**< Id asignado al resultado (malloc, calloc y realloc) */
+} t_trace_record;
+
+/**
+ * @struct s_trace_replay
+ * @brief Resultado de re-ejecutar un trace.
+ */
+typedef struct s_trace_replay
+{
+    size_t ops;          /**< Operaciones re-ejecutadas */
+    size_t failed;       /**< Asignaciones que devolvieron NULL */
+    uint64_t elapsed_ns; /**< Duracion del replay */
+} t_trace_replay;
+
+/**
+ * @brief Abre un archivo de trace y comienza a capturar operaciones.
+ *
+ * Si ya habia una captura activa se cierra antes de abrir la nueva.
+ *
+ * @param path Ruta del archivo a crear o truncar.
+ * @return int 0 si se abrio correctamente, -1 en caso de error.
+ */
+int trace_open(const char* path);
+
+/**
+ * @brief Vuelca los registros pendientes y cierra el trace activo.
+ */
+void trace_close(void);
+
+/**
+ * @brief trace_open sin tomar el lock del heap.
+ *
+ * Para memory.c, que la llama con el lock tomado: trace_record corre bajo ese
+ * lock, asi que el archivo, el buffer y la tabla de ids solo cambian con el.
+ *
+ * @param path Ruta del archivo a crear o truncar.
+ * @return int 0 si se abrio correctamente, -1 en caso de error.
+ */
+int trace_start(const char* path);
+
+/**
+ * @brief trace_close sin tomar el lock del heap (ver trace_start).
+ */
+void trace_stop(void);
+
+/**
+ * @brief Pasa la captura del hijo de un fork a un archivo propio.
+ *
+ * La llama el manejador de pthread_atfork del hijo. Descarta los registros
+ * heredados en el buffer (los vuelca el padre) y la tabla de ids, cierra el
+ * archivo del padre y abre `<ruta>.<pid>`. Sin captura activa no hace nada.
+ */
+void trace_fork_child(void);
+
+/**
+ * @brief Indica si hay una captura activa.
+ *
+ * @return int 1 si se estan registrando operaciones, 0 en caso contrario o si
+ *             el hilo esta dentro de trace_replay.
+ */
+int trace_enabled(void);
+
+/**
+ * @brief Registra una operacion en el trace activo.
+ *
+ * Traduce las direcciones a ids: el resultado recibe un id nuevo y la
+ * direccion de entrada (free/realloc) se da de baja.
+ *
+ * @param op Codigo de operacion (TRACE_MALLOC, TRACE_FREE, ...).
+ * @param size Tamano pedido por el usuario.
+ * @param in Direccion recibida por free o realloc (NULL si no aplica).
+ * @param out Direccion devuelta por malloc, calloc o realloc (NULL si no aplica).
+ */
+void trace_record(int op, size_t size, void* in, void* out);
+
+/**
+ * @brief Codifica un entero sin signo como varint LEB128.
+ *
+ * @param buf Buffer de al menos TRACE_VARINT_MAX bytes.
+ * @param v Valor a codificar.
+ * @return size_t Cantidad de bytes escritos.
+ */
+size_t trace_encode_varint(uint8_t* buf, uint64_t v);
+
+/**
+ * @brief Decodifica un varint LEB128.
+ *
+ * @param buf Inicio del varint.
+ * @param len Bytes disponibles en el buffer.
+ * @param v Donde se guarda el valor decodificado.
+ * @return size_t Bytes consumidos, o 0 si el varint esta truncado o es invalido.
+ */
+size_t trace_decode_varint(const uint8_t* buf, size_t len, uint64_t* v);
+
+/**
+ * @brief Verifica la cabecera de un trace en memoria.
+ *
+ * @param buf Contenido del archivo.
+ * @param len Largo del contenido.
+ * @return size_t Offset del primer registro, o 0 si la cabecera no es valida.
+ */
+size_t trace_check_header(const uint8_t* buf, size_t len);
+
+/**
+ * @brief Decodifica el siguiente registro de un trace en memoria.
+ *
+ * @param buf Contenido del archivo.
+ * @param len Largo del contenido.
+ * @param off Offset actual; se avanza al registro siguiente.
+ * @param rec Registro decodificado.
+ * @return int 1 si se leyo un registro, 0 al final del trace, -1 si esta corrupto.
+ */
+int trace_next(const uint8_t* buf, size_t len, size_t* off, t_trace_record* rec);
+
+/**
+ * @brief Re-ejecuta un trace contra el heap con la politica actual.
+ *
+ * Durante el replay el log de operaciones queda apagado y las operaciones del
+ * replay no se capturan, para que el tiempo y el RSS medidos sean los de la
+ * politica; al terminar se restaura el log. Un trace abierto sigue capturando
+ * las operaciones de los demas hilos. Los bloques que el trace no libera quedan asignados,
+ * asi memory_stats muestra el heap tal como quedo.
+ *
+ * @param buf Contenido del archivo de trace.
+ * @param len Largo del contenido.
+ * @param result Operaciones, asignaciones fallidas y duracion.
+ * @return int 0 si se re-ejecuto todo, -1 si el trace es invalido o esta corrupto
+ *             (result cuenta lo re-ejecutado hasta ahi).
+ */
+int trace_replay(const uint8_t* buf, size_t len, t_trace_replay* result);
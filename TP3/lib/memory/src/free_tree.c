@@ -0,0 +1,348 @@
+#include <free_tree.h>
+
+// Las palabras 0 y 1 del area de datos son los enlaces de la lista de libres
+#define t_left(b) (((t_block*)(b)->data)[2])
+#define t_right(b) (((t_block*)(b)->data)[3])
+#define t_parent(b) (((t_block*)(b)->data)[4])
+// Palabra 5: el bloque de menor direccion del subarbol, con el color en el bit
+// bajo (los bloques estan alineados a 16)
+#define t_aux(b) (((uintptr_t*)(b)->data)[5])
+#define t_min(b) ((t_block)(t_aux(b) & ~(uintptr_t)1))
+
+#define is_red(b) ((b) && (t_aux(b) & 1))
+#define set_red(b, r) (t_aux(b) = (t_aux(b) & ~(uintptr_t)1) | (uintptr_t)(r))
+#define set_min(b, m) (t_aux(b) = (uintptr_t)(m) | (t_aux(b) & 1))
+
+// Orden total: por tamano y, a igual tamano, por direccion
+static int less(t_block a, t_block b)
+{
+    size_t sa = block_size(a);
+    size_t sb = block_size(b);
+    return sa < sb || (sa == sb && a < b);
+}
+
+// Recalcula el minimo de x a partir de sus hijos
+static void pull(t_block x)
+{
+    t_block m = x;
+    if (t_left(x) && t_min(t_left(x)) < m)
+        m = t_min(t_left(x));
+    if (t_right(x) && t_min(t_right(x)) < m)
+        m = t_min(t_right(x));
+    set_min(x, m);
+}
+
+static void rotate_left(t_block* root, t_block x)
+{
+    t_block y = t_right(x);
+    t_right(x) = t_left(y);
+    if (t_left(y))
+        t_parent(t_left(y)) = x;
+    t_parent(y) = t_parent(x);
+    if (!t_parent(x))
+        *root = y;
+    else if (x == t_left(t_parent(x)))
+        t_left(t_parent(x)) = y;
+    else
+        t_right(t_parent(x)) = y;
+    t_left(y) = x;
+    t_parent(x) = y;
+    pull(x);
+    pull(y);
+}
+
+static void rotate_right(t_block* root, t_block x)
+{
+    t_block y = t_left(x);
+    t_left(x) = t_right(y);
+    if (t_right(y))
+        t_parent(t_right(y)) = x;
+    t_parent(y) = t_parent(x);
+    if (!t_parent(x))
+        *root = y;
+    else if (x == t_right(t_parent(x)))
+        t_right(t_parent(x)) = y;
+    else
+        t_left(t_parent(x)) = y;
+    t_right(y) = x;
+    t_parent(x) = y;
+    pull(x);
+    pull(y);
+}
+
+static void insert(t_block* root, t_block z)
+{
+    t_block y = NULL;
+    t_block x = *root;
+    while (x)
+    {
+        // z queda debajo de todos los nodos del camino
+        if (z < t_min(x))
+            set_min(x, z);
+        y = x;
+        x = less(z, x) ? t_left(x) : t_right(x);
+    }
+
+    t_parent(z) = y;
+    t_left(z) = NULL;
+    t_right(z) = NULL;
+    t_aux(z) = (uintptr_t)z | 1;
+    if (!y)
+        *root = z;
+    else if (less(z, y))
+        t_left(y) = z;
+    else
+        t_right(y) = z;
+
+    t_block p;
+    while ((p = t_parent(z)) && is_red(p))
+    {
+        t_block g = t_parent(p);
+        if (p == t_left(g))
+        {
+            t_block u = t_right(g);
+            if (is_red(u))
+            {
+                set_red(p, 0);
+                set_red(u, 0);
+                set_red(g, 1);
+                z = g;
+                continue;
+            }
+            if (z == t_right(p))
+            {
+                z = p;
+                rotate_left(root, z);
+                p = t_parent(z);
+            }
+            set_red(p, 0);
+            set_red(g, 1);
+            rotate_right(root, g);
+        }
+        else
+        {
+            t_block u = t_left(g);
+            if (is_red(u))
+            {
+                set_red(p, 0);
+                set_red(u, 0);
+                set_red(g, 1);
+                z = g;
+                continue;
+            }
+            if (z == t_left(p))
+            {
+                z = p;
+                rotate_right(root, z);
+                p = t_parent(z);
+            }
+            set_red(p, 0);
+            set_red(g, 1);
+            rotate_left(root, g);
+        }
+    }
+    set_red(*root, 0);
+}
+
+// Reemplaza el subarbol u por v en el padre de u
+static void transplant(t_block* root, t_block u, t_block v)
+{
+    if (!t_parent(u))
+        *root = v;
+    else if (u == t_left(t_parent(u)))
+        t_left(t_parent(u)) = v;
+    else
+        t_right(t_parent(u)) = v;
+    if (v)
+        t_parent(v) = t_parent(u);
+}
+
+// x puede ser NULL (hoja), por eso se lleva aparte su padre xp
+static void remove_fixup(t_block* root, t_block x, t_block xp)
+{
+    while (x != *root && !is_red(x))
+    {
+        if (x == t_left(xp))
+        {
+            t_block w = t_right(xp);
+            if (is_red(w))
+            {
+                set_red(w, 0);
+                set_red(xp, 1);
+                rotate_left(root, xp);
+                w = t_right(xp);
+            }
+            if (!is_red(t_left(w)) && !is_red(t_right(w)))
+            {
+                set_red(w, 1);
+                x = xp;
+                xp = t_parent(x);
+            }
+            else
+            {
+                if (!is_red(t_right(w)))
+                {
+                    set_red(t_left(w), 0);
+                    set_red(w, 1);
+                    rotate_right(root, w);
+                    w = t_right(xp);
+                }
+                set_red(w, is_red(xp));
+                set_red(xp, 0);
+                if (t_right(w))
+                    set_red(t_right(w), 0);
+                rotate_left(root, xp);
+                x = *root;
+            }
+        }
+        else
+        {
+            t_block w = t_left(xp);
+            if (is_red(w))
+            {
+                set_red(w, 0);
+                set_red(xp, 1);
+                rotate_right(root, xp);
+                w = t_left(xp);
+            }
+            if (!is_red(t_left(w)) && !is_red(t_right(w)))
+            {
+                set_red(w, 1);
+                x = xp;
+                xp = t_parent(x);
+            }
+            else
+            {
+                if (!is_red(t_left(w)))
+                {
+                    set_red(t_right(w), 0);
+                    set_red(w, 1);
+                    rotate_left(root, w);
+                    w = t_left(xp);
+                }
+                set_red(w, is_red(xp));
+                set_red(xp, 0);
+                if (t_left(w))
+                    set_red(t_left(w), 0);
+                rotate_right(root, xp);
+                x = *root;
+            }
+        }
+    }
+    if (x)
+        set_red(x, 0);
+}
+
+static void remove_node(t_block* root, t_block z)
+{
+    t_block x;
+    t_block xp;
+    int removed_red = is_red(z);
+
+    if (!t_left(z))
+    {
+        x = t_right(z);
+        xp = t_parent(z);
+        transplant(root, z, x);
+    }
+    else if (!t_right(z))
+    {
+        x = t_left(z);
+        xp = t_parent(z);
+        transplant(root, z, x);
+    }
+    else
+    {
+        // Sucesor: el minimo del subarbol derecho toma el lugar de z
+        t_block y = t_right(z);
+        while (t_left(y))
+            y = t_left(y);
+        removed_red = is_red(y);
+        x = t_right(y);
+        if (t_parent(y) == z)
+        {
+            xp = y;
+        }
+        else
+        {
+            xp = t_parent(y);
+            transplant(root, y, x);
+            t_right(y) = t_right(z);
+            t_parent(t_right(y)) = y;
+        }
+        transplant(root, z, y);
+        t_left(y) = t_left(z);
+        t_parent(t_left(y)) = y;
+        set_red(y, is_red(z));
+    }
+
+    // Los minimos cambian desde donde se saco un nodo hasta la raiz
+    for (t_block n = xp; n; n = t_parent(n))
+        pull(n);
+
+    if (!removed_red)
+        remove_fixup(root, x, xp);
+}
+
+void tree_insert(t_free_tree* tree, t_block b)
+{
+    insert(&tree->root, b);
+    if (!tree->max || less(tree->max, b))
+        tree->max = b;
+}
+
+void tree_remove(t_free_tree* tree, t_block b)
+{
+    // El maximo no tiene hijo derecho, y por el balance su hijo izquierdo (si
+    // hay) es una hoja roja: ese o el padre es el predecesor
+    if (b == tree->max)
+        tree->max = t_left(b) ? t_left(b) : t_parent(b);
+    remove_node(&tree->root, b);
+}
+
+t_block tree_lower_bound(const t_free_tree* tree, size_t size)
+{
+    t_block best = NULL;
+    t_block x = tree->root;
+    while (x)
+    {
+        if (block_size(x) >= size)
+        {
+            best = x;
+            x = t_left(x);
+        }
+        else
+        {
+            x = t_right(x);
+        }
+    }
+    return best;
+}
+
+t_block tree_first_fit(const t_free_tree* tree, size_t size)
+{
+    // Si un nodo alcanza, todo su subarbol derecho tambien: se compara su
+    // minimo y se sigue por la izquierda buscando otros que alcancen
+    t_block first = NULL;
+    t_block x = tree->root;
+    while (x)
+    {
+        if (block_size(x) >= size)
+        {
+            t_block m = t_right(x) && t_min(t_right(x)) < x ? t_min(t_right(x)) : x;
+            if (!first || m < first)
+                first = m;
+            x = t_left(x);
+        }
+        else
+        {
+            x = t_right(x);
+        }
+    }
+    return first;
+}
+
+t_block tree_max(const t_free_tree* tree)
+{
+    return tree->max;
+}
@@ -1,4 +1,17 @@
+#define _GNU_SOURCE
+
+#include <free_tree.h>
 #include <memory.h>
+#include <profile.h>
+#include <slab.h>
+#include <trace.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
 
 typedef struct s_block* t_block;
 int registro_malloc = 0;
@@ -6,62 +19,284 @@ int registro_free = 0;
 int registro_realloc = 0;
 int registro_calloc = 0;
 
-t_block base = NULL;
+t_arena arenas = NULL;
 t_log_entry* log_head = NULL;
 int method = 0;
 
-t_block find_block(t_block* last, size_t size)
+// Lista doblemente enlazada de bloques libres (LIFO) para recorrerlos al
+// devolver memoria y al verificar el heap. Los enlaces se guardan en el area de
+// datos del bloque libre, seguidos del nodo del arbol por tamano (free_tree.c)
+// que usan las tres politicas: de ahi MIN_DATA.
+// Hay una lista y un arbol por nodo NUMA; un bloque libre va siempre al heap
+// del nodo de su arena (ver s_arena).
+static t_block free_list[MEM_NUMA_NODES];
+static t_free_tree free_tree[MEM_NUMA_NODES];
+
+// Paginas grandes (set_huge_pages). Las arenas sin usar de los chunks quedan
+// en un pool por nodo, enlazadas por su primera palabra; la segunda guarda los
+// flags del chunk y si la arena ya fue escrita.
+static int huge_pages = 0;
+static void* arena_pool[MEM_NUMA_NODES];
+
+#define CHUNK_ARENA 0x1   // arena de un chunk: vuelve al pool, no se desmapea
+#define CHUNK_THP 0x2     // el rango recibio MADV_HUGEPAGE
+#define CHUNK_HUGETLB 0x4 // chunk de MAP_HUGETLB
+#define POOL_DIRTY 0x8    // arena del pool ya usada: no vale cero
+
+#define ARENAS_PER_CHUNK (HUGE_PAGE_SIZE / ARENA_SIZE)
+#define pool_next(p) (((void**)(p))[0])
+#define pool_flags(p) (((uintptr_t*)(p))[1])
+#define chunk_of(p) ((char*)((uintptr_t)(p) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1)))
+
+// Nodos NUMA en linea (0: todavia no se consulto) y nodo fijado por el hilo
+static int numa_nodes = 0;
+static __thread int thread_node __attribute__((tls_model("initial-exec"))) = -1;
+
+#define free_next(b) (((t_block*)(b)->data)[0])
+#define free_prev(b) (((t_block*)(b)->data)[1])
+
+// Contadores de ocupacion, actualizados en cada operacion
+static t_mem_stats stats;
+
+// Devolucion de memoria al sistema: umbral de la cola libre de una arena y
+// cantidad de arenas que estan completamente libres (se conserva una)
+static size_t trim_threshold = TRIM_THRESHOLD;
+static size_t empty_arenas = 0;
+
+// Los pedidos de hasta SLAB_MAX bytes se sirven desde slabs sin cabecera
+static int slab_enabled = 1;
+
+// Un unico lock protege todo el heap: las funciones publicas lo toman y las
+// internas (do_malloc, do_free, ...) asumen que ya esta tomado
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Registro de cada operacion en log_head (ver add_log). Cargada con LD_PRELOAD
+// en un programa ajeno, el registro (un mmap por operacion) arranca apagado.
+#ifdef MEMORY_PRELOAD
+static int log_enabled = 0;
+#else
+static int log_enabled = 1;
+#endif
+
+// Anidamiento de llamadas publicas: calloc y realloc usan malloc/free por dentro
+// y esas llamadas internas no deben aparecer en el trace.
+static int trace_depth = 0;
+
+// Quien recibe los errores del heap (NULL: stderr, ver set_debug_handler)
+static void (*error_handler)(const char* error, void* ptr) = NULL;
+
+#ifdef MEMORY_DEBUG
+// Trailer de los bloques con BLOCK_DEBUG: un canario justo despues de los bytes
+// pedidos y, en la ultima palabra del bloque, el tamano pedido. El bit alto de
+// esa palabra marca los bloques que estan en cuarentena.
+#define DEBUG_TRAILER (2 * sizeof(size_t))
+#define DEBUG_CANARY_WORD 0xC0DEFEEDFACEB00CULL
+#define DEBUG_QUARANTINED ((size_t)1 << (sizeof(size_t) * 8 - 1))
+#define DEBUG_FILL 0xDD
+#define DEBUG_QUARANTINE_SLOTS 256
+#define DEBUG_QUARANTINE_BYTES (1024 * 1024)
+#define debug_word(b) (((size_t*)((b)->data + block_size(b)))[-1])
+
+static int debug_flags = 0;
+
+// Cola circular de bloques liberados que todavia no vuelven al heap
+static t_block quarantine[DEBUG_QUARANTINE_SLOTS];
+static size_t quarantine_head = 0;
+static size_t quarantine_count = 0;
+static size_t quarantine_bytes = 0;
+#endif
+
+static void trace_op(int op, size_t size, void* in, void* out)
 {
-    t_block b = base;
+    if (trace_depth == 0 && trace_enabled())
+        trace_record(op, size, in, out);
+}
 
-    switch (method)
+// Reporta un error del heap. Sin manejador propio se escribe en stderr sin pedir
+// memoria (el lock esta tomado) y, si se detecto en una operacion, se aborta.
+static void heap_error(const char* error, void* ptr, int fatal)
+{
+    if (error_handler)
     {
-    case FIRST_FIT:
-        while (b && !(b->free && b->size >= size))
+        error_handler(error, ptr);
+        return;
+    }
+
+    char line[160];
+    int len = snprintf(line, sizeof(line), "MemoryLib: %s (%p)\n", error, ptr);
+    if (len > 0)
+    {
+        ssize_t written = write(STDERR_FILENO, line, (size_t)len);
+        (void)written;
+    }
+    if (fatal)
+        abort();
+}
+
+static size_t page_round(size_t n)
+{
+    return (n + PAGESIZE - 1) & ~(size_t)(PAGESIZE - 1);
+}
+
+static uintptr_t page_floor(uintptr_t n)
+{
+    return n & ~(uintptr_t)(PAGESIZE - 1);
+}
+
+static int online_nodes(void)
+{
+    if (numa_nodes)
+        return numa_nodes;
+
+    // Lista de rangos, por ejemplo "0-1"; sin NUMA el archivo no existe
+    numa_nodes = 1;
+    char buf[128];
+    int fd = open("/sys/devices/system/node/online", O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return numa_nodes;
+    ssize_t n = read(fd, buf, sizeof(buf));
+    close(fd);
+
+    int last = 0;
+    int v = 0;
+    for (ssize_t i = 0; i < n; i++)
+    {
+        if (buf[i] >= '0' && buf[i] <= '9')
         {
-            *last = b;
-            b = b->next;
+            v = v * 10 + (buf[i] - '0');
+            if (v > last)
+                last = v;
         }
-        return b;
-
-    case BEST_FIT: {
-        size_t dif = PAGESIZE;
-        t_block best = NULL;
-        while (b)
+        else
         {
-            if (b->free)
-            {
-                if (b->size == size)
-                    return b;
-                if (b->size > size && (b->size - size) < dif)
-                {
-                    dif = b->size - size;
-                    best = b;
-                }
-            }
-            *last = b;
-            b = b->next;
+            v = 0;
         }
-        return best;
     }
+    numa_nodes = last + 1;
+    return numa_nodes;
+}
+
+// Heap que corresponde al hilo que llama
+static int current_node(void)
+{
+    if (thread_node >= 0)
+        return thread_node % MEM_NUMA_NODES;
+    if (online_nodes() == 1)
+        return 0;
+
+    unsigned int cpu;
+    unsigned int node;
+    if (getcpu(&cpu, &node) != 0)
+        return 0;
+    return (int)(node % MEM_NUMA_NODES);
+}
+
+// Pide que las paginas del rango se ubiquen en el nodo (preferencia, no
+// obligacion: si el nodo se queda sin memoria el kernel usa otro)
+static void bind_node(void* addr, size_t len, int node)
+{
+    if (online_nodes() == 1)
+        return;
+    unsigned long mask = 1UL << node;
+    syscall(SYS_mbind, addr, len, MPOL_PREFERRED, &mask, sizeof(mask) * 8 + 1, 0);
+}
+
+static int size_class(size_t size)
+{
+    int c = (int)(sizeof(unsigned long) * 8 - 1) - __builtin_clzl((unsigned long)size) - MEM_CLASS_SHIFT;
+    if (c < 0)
+        return 0;
+    return c < MEM_SIZE_CLASSES ? c : MEM_SIZE_CLASSES - 1;
+}
+
+static void used_add(size_t size)
+{
+    stats.used_bytes += size;
+    stats.used_blocks++;
+    stats.used_by_class[size_class(size)]++;
+}
+
+static void used_sub(size_t size)
+{
+    stats.used_bytes -= size;
+    stats.used_blocks--;
+    stats.used_by_class[size_class(size)]--;
+}
+
+// Escribe la cabecera y replica la etiqueta en el footer (prev_foot del siguiente)
+static void set_head(t_block b, size_t size, size_t flags)
+{
+    b->head = size | flags;
+    next_block(b)->prev_foot = b->head;
+}
+
+static void insert_free(t_block b)
+{
+    size_t size = block_size(b);
+    stats.free_bytes += size;
+    stats.free_blocks++;
+    stats.free_by_class[size_class(size)]++;
+
+    int node = arena_of(b)->node;
+    tree_insert(&free_tree[node], b);
+    free_next(b) = free_list[node];
+    free_prev(b) = NULL;
+    if (free_list[node])
+        free_prev(free_list[node]) = b;
+    free_list[node] = b;
+}
+
+static void remove_free(t_block b)
+{
+    size_t size = block_size(b);
+    stats.free_bytes -= size;
+    stats.free_blocks--;
+    stats.free_by_class[size_class(size)]--;
+
+    int node = arena_of(b)->node;
+    tree_remove(&free_tree[node], b);
+    if (free_prev(b))
+        free_next(free_prev(b)) = free_next(b);
+    else
+        free_list[node] = free_next(b);
+    if (free_next(b))
+        free_prev(free_next(b)) = free_prev(b);
+}
+
+static void link_arena(t_arena a)
+{
+    a->prev = NULL;
+    a->next = arenas;
+    if (arenas)
+        arenas->prev = a;
+    arenas = a;
+}
+
+static void unlink_arena(t_arena a)
+{
+    if (a->prev)
+        a->prev->next = a->next;
+    else
+        arenas = a->next;
+    if (a->next)
+        a->next->prev = a->prev;
+}
+
+static t_block find_in_node(size_t size, int node)
+{
+    switch (method)
+    {
+    case FIRST_FIT:
+        // El primero que alcanza recorriendo el heap por direccion
+        return tree_first_fit(&free_tree[node], size);
+
+    case BEST_FIT:
+        // El menor bloque que alcanza; a igual tamano, el de menor direccion
+        return tree_lower_bound(&free_tree[node], size);
 
     case WORST_FIT: {
-        size_t max_size = 0;
-        t_block worst = NULL;
-        while (b)
-        {
-            if (b->free && b->size >= size)
-            {
-                if (b->size > max_size)
-                {
-                    max_size = b->size;
-                    worst = b;
-                }
-            }
-            *last = b;
-            b = b->next;
-        }
-        return worst;
+        t_block worst = tree_max(&free_tree[node]);
+        return worst && block_size(worst) >= size ? worst : NULL;
     }
 
     default:
@@ -70,35 +305,32 @@ t_block find_block(t_block* last, size_t size)
     }
 }
 
+t_block find_block(size_t size)
+{
+    return find_in_node(size, current_node());
+}
+
 void split_block(t_block b, size_t s)
 {
-    if (b->size <= s + BLOCK_SIZE)
+    size_t size = block_size(b);
+    if (size < s + BLOCK_SIZE + MIN_DATA)
     {
         return;
     }
 
-    t_block new = (t_block)(b->data + s);
-    new->size = b->size - s - BLOCK_SIZE;
-    new->next = b->next;
-    new->prev = b;
-    new->free = 1;
-    new->ptr = new->data;
-
-    if (b->next)
-    {
-        b->next->prev = new;
-    }
+    set_head(b, s, b->head & BLOCK_FLAGS);
 
-    b->size = s;
-    b->next = new;
+    t_block new = next_block(b);
+    set_head(new, size - s - BLOCK_SIZE, BLOCK_FREE);
+    insert_free(fusion(new));
 }
 
 void copy_block(t_block src, t_block dst)
 {
     size_t i;
-    char* sdata = (char*)src->ptr;
-    char* ddata = (char*)dst->ptr;
-    size_t n = src->size < dst->size ? src->size : dst->size;
+    char* sdata = src->data;
+    char* ddata = dst->data;
+    size_t n = block_size(src) < block_size(dst) ? block_size(src) : block_size(dst);
 
     for (i = 0; i < n; i++)
         ddata[i] = sdata[i];
@@ -106,24 +338,24 @@ void copy_block(t_block src, t_block dst)
 
 t_block get_block(void* p)
 {
-    t_block b = base;
-    while (b)
-    {
-        if (b->ptr == p)
-            return b;
-        b = b->next;
-    }
-    return NULL;
+    return (t_block)((char*)p - BLOCK_SIZE);
+}
+
+// Chequeo barato de una cabecera: ocupada y con el footer igual a la cabecera
+static int block_ok(t_block b)
+{
+    return ((uintptr_t)b & (MALLOC_ALIGN - 1)) == 0 && !is_epilogue(b) && !block_is_free(b) &&
+           next_block(b)->prev_foot == b->head;
 }
 
 int valid_addr(void* p)
 {
-    if (base)
+    // El heap vive en mapeos propios, no entre base y sbrk(0)
+    for (t_arena a = arenas; a; a = a->next)
     {
-        if ((char*)p > (char*)base && (char*)p < (char*)sbrk(0))
+        if ((char*)p >= arena_first(a)->data && (char*)p < (char*)a + a->size)
         {
-            t_block b = get_block(p);
-            return b && (p == b->ptr);
+            return block_ok(get_block(p));
         }
     }
     return (0);
@@ -131,44 +363,403 @@ int valid_addr(void* p)
 
 t_block fusion(t_block c)
 {
-    // Retroceder mientras haya libres antes
-    while (c->prev && c->prev->free)
+    // Vecino anterior: su tamano esta en el footer
+    if (prev_is_free(c))
     {
-        c = c->prev;
+        t_block p = prev_block(c);
+        remove_free(p);
+        set_head(p, block_size(p) + BLOCK_SIZE + block_size(c), BLOCK_FREE);
+        c = p;
     }
 
-    // Compactar hacia adelante
-    while (c->next && c->next->free)
+    // Vecino siguiente
+    t_block n = next_block(c);
+    if (block_is_free(n))
     {
-        c->size += BLOCK_SIZE + c->next->size;
-        c->next = c->next->next;
-        if (c->next)
-            c->next->prev = c;
+        remove_free(n);
+        set_head(c, block_size(c) + BLOCK_SIZE + block_size(n), BLOCK_FREE);
     }
     return c;
 }
 
-t_block extend_heap(t_block last, size_t s)
+// Pide una arena de ARENA_SIZE alineada a su tamano: se mapea el doble y se
+// recortan los sobrantes de ambos lados.
+static t_arena map_arena(void)
 {
-    t_block b;
-    b = mmap(0, s + BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    char* raw = mmap(0, 2 * ARENA_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return MAP_FAILED;
+
+    char* a = (char*)(((uintptr_t)raw + ARENA_SIZE - 1) & ~(uintptr_t)(ARENA_SIZE - 1));
+    if (a > raw)
+        munmap(raw, (size_t)(a - raw));
+    if (a + ARENA_SIZE < raw + 2 * ARENA_SIZE)
+        munmap(a + ARENA_SIZE, (size_t)(raw + ARENA_SIZE - a));
+    return (t_arena)a;
+}
+
+static void pool_put(void* slot, int node, uintptr_t flags)
+{
+    pool_next(slot) = arena_pool[node];
+    pool_flags(slot) = flags;
+    arena_pool[node] = slot;
+    stats.huge_pool_bytes += ARENA_SIZE;
+}
 
-    if (b == MAP_FAILED)
+// Mapea un chunk de HUGE_PAGE_SIZE alineado y deja sus arenas en el pool
+static int map_chunk(int node)
+{
+    uintptr_t flags = CHUNK_ARENA | CHUNK_THP | CHUNK_HUGETLB;
+    char* c = mmap(0, HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+    if (c == MAP_FAILED)
     {
+        // Sin paginas hugetlb reservadas: THP sobre un rango alineado
+        flags = CHUNK_ARENA | CHUNK_THP;
+        char* raw = mmap(0, 2 * HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            return -1;
+        c = chunk_of(raw + HUGE_PAGE_SIZE - 1);
+        if (c > raw)
+            munmap(raw, (size_t)(c - raw));
+        munmap(c + HUGE_PAGE_SIZE, (size_t)(raw + HUGE_PAGE_SIZE - c));
+        if (madvise(c, HUGE_PAGE_SIZE, MADV_HUGEPAGE) != 0)
+            flags = CHUNK_ARENA; // el kernel no tiene THP: quedan paginas comunes
+    }
+    bind_node(c, HUGE_PAGE_SIZE, node);
+
+    if (flags & CHUNK_THP)
+        stats.huge_bytes += HUGE_PAGE_SIZE;
+    if (flags & CHUNK_HUGETLB)
+        stats.hugetlb_bytes += HUGE_PAGE_SIZE;
+    for (int i = ARENAS_PER_CHUNK - 1; i >= 0; i--)
+        pool_put(c + (size_t)i * ARENA_SIZE, node, flags);
+    return 0;
+}
+
+// Toma una arena del pool del nodo (o de un chunk nuevo si las paginas grandes
+// estan activas). Devuelve NULL si hay que usar map_arena.
+static t_arena pool_get(int node, uintptr_t* flags)
+{
+    if (!arena_pool[node] && (!huge_pages || map_chunk(node) != 0))
         return NULL;
+
+    void* slot = arena_pool[node];
+    arena_pool[node] = pool_next(slot);
+    *flags = pool_flags(slot);
+    stats.huge_pool_bytes -= ARENA_SIZE;
+    return (t_arena)slot;
+}
+
+// Desmapea los chunks que tienen todas sus arenas en el pool
+static size_t pool_trim(void)
+{
+    size_t released = 0;
+    for (int node = 0; node < MEM_NUMA_NODES; node++)
+    {
+        void* p = arena_pool[node];
+        while (p)
+        {
+            char* c = chunk_of(p);
+            uintptr_t flags = pool_flags(p);
+            int count = 0;
+            for (void* q = arena_pool[node]; q; q = pool_next(q))
+                count += chunk_of(q) == c;
+            if (count < ARENAS_PER_CHUNK)
+            {
+                p = pool_next(p);
+                continue;
+            }
+
+            for (void** link = &arena_pool[node]; *link;)
+            {
+                if (chunk_of(*link) == c)
+                    *link = pool_next(*link);
+                else
+                    link = &pool_next(*link);
+            }
+            munmap(c, HUGE_PAGE_SIZE);
+            stats.huge_pool_bytes -= HUGE_PAGE_SIZE;
+            if (flags & CHUNK_THP)
+                stats.huge_bytes -= HUGE_PAGE_SIZE;
+            if (flags & CHUNK_HUGETLB)
+                stats.hugetlb_bytes -= HUGE_PAGE_SIZE;
+            released += HUGE_PAGE_SIZE;
+            p = arena_pool[node];
+        }
     }
-    b->size = s;
-    b->next = NULL;
-    b->prev = last;
-    b->ptr = b->data;
+    return released;
+}
 
-    if (last)
-        last->next = b;
+// Bytes de paginas grandes enteras dentro de un rango
+static size_t huge_span(uintptr_t base, size_t len)
+{
+    uintptr_t start = (base + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    uintptr_t end = (base + len) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+    return end > start ? end - start : 0;
+}
 
-    b->free = 0;
+// Mapeo propio para un bloque grande con los datos alineados a `alignment`.
+// La cabecera de la arena queda justo antes del bloque y, si la alineacion lo
+// pide, a mitad de la primera pagina: el mapeo empieza en la pagina que la
+// contiene y a->size es el largo del mapeo completo.
+static t_block map_direct(size_t s, size_t alignment)
+{
+    size_t extra = alignment > BLOCK_SIZE ? alignment : 0;
+#ifdef MEMORY_DEBUG
+    // Pagina sin permisos despues del epilogo: un desborde largo da SIGSEGV
+    size_t guard = (debug_flags & DEBUG_GUARD) ? PAGESIZE : 0;
+#else
+    size_t guard = 0;
+#endif
+    size_t raw_len = page_round(ARENA_HEADER + s + 2 * BLOCK_SIZE + extra) + guard;
+    char* raw = mmap(0, raw_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+
+    uintptr_t data = ((uintptr_t)raw + ARENA_HEADER + BLOCK_SIZE + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    t_arena a = (t_arena)(data - BLOCK_SIZE - ARENA_HEADER);
+    uintptr_t base = page_floor((uintptr_t)a);
+    uintptr_t end = page_round(data + s + BLOCK_SIZE);
+    if (base > (uintptr_t)raw)
+        munmap(raw, base - (uintptr_t)raw);
+    if (end + guard < (uintptr_t)raw + raw_len)
+        munmap((void*)(end + guard), (uintptr_t)raw + raw_len - end - guard);
+    if (guard)
+        mprotect((void*)end, guard, PROT_NONE);
+
+    a->size = end + guard - base;
+    a->node = current_node();
+    a->chunk = 0;
+    bind_node((void*)base, a->size, a->node);
+    if (huge_pages && s >= HUGE_PAGE_SIZE && madvise((void*)base, a->size, MADV_HUGEPAGE) == 0)
+    {
+        a->chunk = CHUNK_THP;
+        stats.huge_bytes += huge_span(base, a->size);
+    }
+    link_arena(a);
+    stats.mapped_bytes += a->size;
+    stats.mapped_blocks++;
+
+    t_block b = arena_first(a);
+    b->prev_foot = 0;
+    set_head(b, end - data - BLOCK_SIZE, BLOCK_MAPPED);
+    next_block(b)->head = 0;
+    return b;
+}
+
+t_block extend_heap(size_t s)
+{
+    if (s >= MMAP_THRESHOLD)
+        return map_direct(s, MALLOC_ALIGN);
+
+    size_t len = page_round(ARENA_HEADER + s + 2 * BLOCK_SIZE);
+    if (len < ARENA_SIZE)
+        len = ARENA_SIZE;
+
+    int node = current_node();
+    uintptr_t chunk = 0;
+    t_arena a = pool_get(node, &chunk);
+    if (!a)
+    {
+        a = map_arena();
+        if (a == MAP_FAILED)
+        {
+            return NULL;
+        }
+        bind_node(a, len, node);
+    }
+    a->size = len;
+    a->node = node;
+    a->chunk = (int)(chunk & ~(uintptr_t)POOL_DIRTY);
+    link_arena(a);
+    stats.mapped_bytes += len;
+    stats.arena_count++;
+
+    // Prologo implicito (prev_foot 0) y epilogo con head 0 al final del mapeo
+    t_block b = arena_first(a);
+    b->prev_foot = 0;
+    set_head(b, len - ARENA_HEADER - 2 * BLOCK_SIZE, 0);
+    next_block(b)->head = 0;
+    a->fresh = (chunk & POOL_DIRTY) ? (char*)next_block(b) : b->data;
+
+    // La cola de la arena queda libre para las proximas asignaciones
+    split_block(b, s);
     return b;
 }
 
+// Devuelve al sistema un bloque con mapeo propio
+static void unmap_block(t_block b)
+{
+    t_arena a = (t_arena)((char*)b - ARENA_HEADER);
+    unlink_arena(a);
+    stats.mapped_bytes -= a->size;
+    stats.mapped_blocks--;
+    if (a->chunk & CHUNK_THP)
+        stats.huge_bytes -= huge_span(page_floor((uintptr_t)a), a->size);
+    munmap((void*)page_floor((uintptr_t)a), a->size);
+}
+
+// Un bloque libre que ocupa toda su arena (primer bloque seguido del epilogo)
+static int arena_is_empty(t_block b)
+{
+    return b->prev_foot == 0 && !block_is_mapped(b) && is_epilogue(next_block(b));
+}
+
+// Desmapea una arena vacia; su unico bloque tiene que estar en la lista de libres
+static void unmap_arena(t_block b)
+{
+    t_arena a = arena_of(b);
+    remove_free(b);
+    unlink_arena(a);
+    stats.mapped_bytes -= a->size;
+    stats.arena_count--;
+    empty_arenas--;
+    if (a->chunk & CHUNK_ARENA)
+        pool_put(a, a->node, (uintptr_t)a->chunk | POOL_DIRTY);
+    else
+        munmap(a, a->size);
+}
+
+// Libera con madvise las paginas enteras de un bloque libre, sin tocar sus
+// enlaces ni la etiqueta del siguiente. En la cola de la arena solo hace falta
+// llegar hasta fresh, y la cola entera vuelve a contar como nunca escrita.
+static size_t release_pages(t_block b, size_t keep)
+{
+    t_arena a = arena_of(b);
+    t_block n = next_block(b);
+    uintptr_t start = page_round((uintptr_t)(b->data + MIN_DATA + keep));
+    uintptr_t end = page_floor((uintptr_t)n);
+    int tail = is_epilogue(n);
+
+    // Liberar una parte de una pagina grande la partiria en paginas comunes
+    if (a->chunk)
+        return 0;
+    if (tail && page_round((uintptr_t)a->fresh) < end)
+        end = page_round((uintptr_t)a->fresh);
+    if (end <= start || madvise((void*)start, end - start, MADV_DONTNEED) != 0)
+        return 0;
+
+    // El resto de la ultima pagina (antes del epilogo) se limpia a mano
+    if (tail)
+    {
+        if ((uintptr_t)a->fresh > end)
+            memset((void*)end, 0, (size_t)((uintptr_t)n - end));
+        a->fresh = (char*)start;
+    }
+    stats.released_bytes += end - start;
+    return end - start;
+}
+
+// Politica de free(): desmapea las arenas vacias salvo una de repuesto y
+// libera la cola de una arena cuando junto trim_threshold bytes escritos
+static void trim_free_block(t_block b)
+{
+    if (arena_is_empty(b))
+    {
+        empty_arenas++;
+        if (empty_arenas > 1 && trim_threshold != (size_t)-1)
+        {
+            unmap_arena(b);
+            return;
+        }
+    }
+
+    t_block n = next_block(b);
+    char* fresh = arena_of(b)->fresh;
+    if (is_epilogue(n) && fresh > b->data && (size_t)(fresh - b->data) >= trim_threshold)
+        release_pages(b, 0);
+}
+
+// Redimensiona un bloque con mapeo propio sin copiar: el kernel mueve las
+// paginas y la cabecera conserva su desplazamiento dentro de la primera
+static void* remap_block(t_block b, size_t s)
+{
+    t_arena a = (t_arena)((char*)b - ARENA_HEADER);
+    uintptr_t base = page_floor((uintptr_t)a);
+    size_t off = (uintptr_t)a - base;
+    size_t len = page_round(off + ARENA_HEADER + s + 2 * BLOCK_SIZE);
+    if (len == a->size)
+        return b->data;
+
+    unlink_arena(a);
+    char* nbase = mremap((void*)base, a->size, len, MREMAP_MAYMOVE);
+    if (nbase == MAP_FAILED)
+    {
+        link_arena(a);
+        return NULL;
+    }
+    t_arena na = (t_arena)(nbase + off);
+    stats.mapped_bytes += len - na->size;
+    if (na->chunk & CHUNK_THP)
+        stats.huge_bytes += huge_span((uintptr_t)nbase, len) - huge_span(base, na->size);
+    na->size = len;
+    link_arena(na);
+
+    b = arena_first(na);
+    used_sub(block_size(b));
+    set_head(b, len - off - ARENA_HEADER - 2 * BLOCK_SIZE, BLOCK_MAPPED);
+    used_add(block_size(b));
+    next_block(b)->head = 0;
+    return b->data;
+}
+
+void set_slab_enabled(int enabled)
+{
+    slab_enabled = enabled;
+}
+
+void set_huge_pages(int enabled)
+{
+    pthread_mutex_lock(&heap_lock);
+    huge_pages = enabled;
+    pthread_mutex_unlock(&heap_lock);
+}
+
+void set_numa_node(int node)
+{
+    thread_node = node;
+}
+
+void set_trim_threshold(size_t bytes)
+{
+    trim_threshold = bytes;
+}
+
+int malloc_trim(size_t pad)
+{
+    pthread_mutex_lock(&heap_lock);
+    size_t released = 0;
+    for (int node = 0; node < MEM_NUMA_NODES; node++)
+    {
+        t_block b = free_list[node];
+        while (b)
+        {
+            t_block next = free_next(b);
+            if (arena_is_empty(b) && pad == 0)
+            {
+                // Las arenas de un chunk van al pool; el chunk se libera entero despues
+                if (!arena_of(b)->chunk)
+                    released += arena_of(b)->size;
+                unmap_arena(b);
+            }
+            else
+            {
+                released += release_pages(b, is_epilogue(next_block(b)) ? pad : 0);
+            }
+            b = next;
+        }
+    }
+
+    if (pad == 0)
+        released += pool_trim();
+
+    size_t slabs = slab_trim();
+    stats.released_bytes += slabs;
+    pthread_mutex_unlock(&heap_lock);
+    return released + slabs > 0;
+}
+
 void get_method(int m)
 {
     method = m;
@@ -191,137 +782,614 @@ void malloc_control(int m)
         printf("Error: invalid method\n");
 }
 
-void* malloc(size_t size)
+// Registra en la arena que el bloque entregado y la cabecera (y enlaces) del
+// siguiente ya fueron escritos. Devuelve desde donde los datos siguen en cero.
+static char* mark_written(t_block b)
 {
-    registro_malloc++;
-    t_block b, last;
-    size_t s;
-    s = align(size);
+    if (block_is_mapped(b))
+        return b->data; // mapeo recien creado: todo en cero
+
+    t_arena a = arena_of(b);
+    char* zero = a->fresh > b->data ? a->fresh : b->data;
+    t_block n = next_block(b);
+    char* end = is_epilogue(n) ? (char*)n : n->data + MIN_DATA;
+    if (end > a->fresh)
+        a->fresh = end;
+    return zero;
+}
 
-    add_log("malloc", s, (unsigned int)registro_malloc);
+// Bloque ocupado de al menos s bytes (s alineado y >= MIN_DATA) de una arena o
+// de un mapeo propio
+static t_block allocate_block(size_t s)
+{
+    t_block b = NULL;
+
+    // Los pedidos grandes no se buscan en las arenas: van a un mapeo propio
+    if (s < MMAP_THRESHOLD)
+        b = find_block(s);
 
-    if (base)
+    // Sin lugar en el heap del nodo se mapea una arena nueva en el nodo; los
+    // heaps de los otros nodos solo se usan si el sistema no da mas memoria
+    t_block fresh = b ? NULL : extend_heap(s);
+    for (int node = 0; !b && !fresh && s < MMAP_THRESHOLD && node < MEM_NUMA_NODES; node++)
+        b = find_in_node(s, node);
+
+    if (b)
     {
-        last = base;
-        b = find_block(&last, s);
-        if (b)
-        {
-            if ((b->size - s) >= (BLOCK_SIZE + 4))
-                split_block(b, s);
-            b->free = 0;
-        }
-        else
+        if (arena_is_empty(b))
+            empty_arenas--;
+        remove_free(b);
+        set_head(b, block_size(b), 0);
+        split_block(b, s);
+    }
+    else if (fresh)
+    {
+        b = fresh;
+    }
+    else
+    {
+        return (NULL);
+    }
+    used_add(block_size(b));
+    return b;
+}
+
+static void* allocate(size_t s, char** zero_from)
+{
+#ifdef MEMORY_DEBUG
+    // Los objetos de los slabs no tienen cabecera donde marcar el trailer
+    if (slab_enabled && s <= SLAB_MAX && !debug_flags)
+#else
+    if (slab_enabled && s <= SLAB_MAX)
+#endif
+    {
+        char* p = slab_alloc(s);
+        if (p)
         {
-            b = extend_heap(last, s);
-            if (!b)
-                return (NULL);
+            used_add(slab_usable_size(p));
+            stats.slab_used_bytes += slab_usable_size(p);
+            if (zero_from)
+                *zero_from = p + slab_usable_size(p); // los objetos se reutilizan sin limpiar
+            return p;
         }
     }
-    else
+
+    if (s < MIN_DATA)
+        s = MIN_DATA;
+
+    t_block b = allocate_block(s);
+    if (!b)
+        return (NULL);
+
+    char* zero = mark_written(b);
+    if (zero_from)
+        *zero_from = zero;
+    return (b->data);
+}
+
+// Bloque con los datos alineados a `alignment` (potencia de 2 mayor a
+// MALLOC_ALIGN). Se pide un bloque con lugar para el relleno y el relleno del
+// inicio queda como bloque libre, asi que tiene que alcanzar para uno.
+static void* allocate_aligned(size_t alignment, size_t s)
+{
+    if (s < MIN_DATA)
+        s = MIN_DATA;
+
+    size_t need = s + alignment + BLOCK_SIZE + MIN_DATA;
+    if (need >= MMAP_THRESHOLD)
     {
-        b = extend_heap(NULL, s);
-        if (!b)
+        t_block m = map_direct(s, alignment);
+        if (!m)
             return (NULL);
-        base = b;
+        used_add(block_size(m));
+        return (m->data);
     }
+
+    t_block b = allocate_block(need);
+    if (!b)
+        return (NULL);
+    mark_written(b);
+
+    uintptr_t data = (uintptr_t)b->data;
+    uintptr_t a = (data + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (a != data)
+    {
+        while (a - data < BLOCK_SIZE + MIN_DATA)
+            a += alignment;
+
+        size_t total = block_size(b);
+        size_t lead = a - data - BLOCK_SIZE;
+        t_block nb = (t_block)(a - BLOCK_SIZE);
+        used_sub(total);
+        set_head(b, lead, BLOCK_FREE);
+        set_head(nb, total - lead - BLOCK_SIZE, 0);
+        insert_free(fusion(b));
+        used_add(block_size(nb));
+        b = nb;
+    }
+
+    // El sobrante del final vuelve al heap
+    used_sub(block_size(b));
+    split_block(b, s);
+    used_add(block_size(b));
     return (b->data);
 }
 
-void free(void* ptr)
+#ifdef MEMORY_DEBUG
+static int debug_canary_ok(t_block b, size_t size)
+{
+    uint64_t canary;
+    memcpy(&canary, b->data + size, sizeof(canary)); // size no esta alineado
+    return canary == DEBUG_CANARY_WORD;
+}
+
+// Marca un bloque recien entregado y escribe su trailer
+static void debug_arm(void* p, size_t size)
+{
+    t_block b = get_block(p);
+    uint64_t canary = DEBUG_CANARY_WORD;
+    set_head(b, block_size(b), (b->head & BLOCK_FLAGS) | BLOCK_DEBUG);
+    memcpy(b->data + size, &canary, sizeof(canary));
+    debug_word(b) = size;
+}
+
+// Lo que se encontro roto en el trailer (o en el contenido, si el bloque esta
+// en cuarentena) de un bloque con BLOCK_DEBUG; NULL si esta intacto
+static const char* debug_block_error(t_block b)
+{
+    size_t word = debug_word(b);
+    size_t size = word & ~DEBUG_QUARANTINED;
+    if (size + DEBUG_TRAILER > block_size(b) || !debug_canary_ok(b, size))
+        return "desborde despues del bloque: canario pisado";
+    if (word & DEBUG_QUARANTINED)
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            if ((unsigned char)b->data[i] != DEBUG_FILL)
+                return "escritura despues de free: bloque en cuarentena modificado";
+        }
+    }
+    return NULL;
+}
+#endif
+
+static void* do_malloc(size_t size, char** zero_from)
+{
+    registro_malloc++;
+    if (size > MAX_REQUEST)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size_t s = align(size);
+#ifdef MEMORY_DEBUG
+    if (debug_flags)
+        s = align(size + DEBUG_TRAILER);
+#endif
+
+    add_log("malloc", s, (unsigned int)registro_malloc);
+
+    void* p = allocate(s, zero_from);
+#ifdef MEMORY_DEBUG
+    if (p && debug_flags)
+        debug_arm(p, size);
+#endif
+    trace_op(TRACE_MALLOC, size, NULL, p);
+    return p;
+}
+
+void* malloc(size_t size)
+{
+    pthread_mutex_lock(&heap_lock);
+    void* p = do_malloc(size, NULL);
+    pthread_mutex_unlock(&heap_lock);
+    if (p)
+        profile_sample(size);
+    return p;
+}
+
+// Devuelve un bloque a su slab o al heap. 0 si ptr no era un bloque ocupado.
+static int release(void* ptr)
+{
+    if (slab_owns(ptr))
+    {
+        size_t size = slab_free(ptr);
+        if (!size)
+            return 0;
+        used_sub(size);
+        stats.slab_used_bytes -= size;
+        return 1;
+    }
+
+    t_block c = get_block(ptr);
+    if (!block_ok(c))
+        return 0;
+
+    used_sub(block_size(c));
+    if (block_is_mapped(c))
+    {
+        unmap_block(c);
+        return 1;
+    }
+    if (arena_of(c)->node != current_node())
+        stats.remote_frees++;
+    set_head(c, block_size(c), BLOCK_FREE);
+    c = fusion(c);
+    insert_free(c);
+    trim_free_block(c);
+    return 1;
+}
+
+#ifdef MEMORY_DEBUG
+// Saca de la cuarentena el bloque mas viejo, verifica que nadie lo haya
+// escrito y lo devuelve al heap
+static void quarantine_evict(void)
+{
+    t_block b = quarantine[quarantine_head];
+    quarantine_head = (quarantine_head + 1) % DEBUG_QUARANTINE_SLOTS;
+    quarantine_count--;
+    quarantine_bytes -= debug_word(b) & ~DEBUG_QUARANTINED;
+
+    const char* error = debug_block_error(b);
+    if (error)
+        heap_error(error, b->data, 1);
+    if (!release(b->data))
+        heap_error("cabecera pisada mientras el bloque estaba en cuarentena", b->data, 1);
+}
+
+static void quarantine_push(t_block b, size_t size)
+{
+    memset(b->data, DEBUG_FILL, size);
+    debug_word(b) = size | DEBUG_QUARANTINED;
+    if (quarantine_count == DEBUG_QUARANTINE_SLOTS)
+        quarantine_evict();
+    quarantine[(quarantine_head + quarantine_count) % DEBUG_QUARANTINE_SLOTS] = b;
+    quarantine_count++;
+    quarantine_bytes += size;
+    while (quarantine_bytes > DEBUG_QUARANTINE_BYTES && quarantine_count > 1)
+        quarantine_evict();
+}
+
+static void debug_free(void* ptr)
+{
+    // Bloques sin trailer (slabs o pedidos antes de activar la depuracion):
+    // solo se puede detectar que no estan ocupados
+    if (slab_owns(ptr) || !(get_block(ptr)->head & BLOCK_DEBUG))
+    {
+        if (!release(ptr))
+            heap_error("free de un puntero invalido o ya liberado", ptr, 1);
+        return;
+    }
+
+    t_block b = get_block(ptr);
+    if (!block_ok(b))
+    {
+        heap_error("cabecera pisada: no coincide con la etiqueta de frontera", ptr, 1);
+        return;
+    }
+    if (debug_word(b) & DEBUG_QUARANTINED)
+    {
+        heap_error("doble free de un bloque en cuarentena", ptr, 1);
+        return;
+    }
+
+    const char* error = debug_block_error(b);
+    if (error)
+    {
+        heap_error(error, ptr, 1);
+        release(ptr);
+        return;
+    }
+    if (debug_flags & DEBUG_QUARANTINE)
+        quarantine_push(b, debug_word(b));
+    else
+        release(ptr);
+}
+#endif
+
+static void do_free(void* ptr)
 {
     registro_free++;
     add_log("free", 0, (unsigned int)registro_free);
-    if (valid_addr(ptr))
+    trace_op(TRACE_FREE, 0, ptr, NULL);
+    if (!ptr)
+        return;
+
+#ifdef MEMORY_DEBUG
+    if (debug_flags)
     {
-        t_block c = get_block(ptr);
-        c->free = 1;
-        c = fusion(c);
-        if (!c->prev)
-            base = c;
+        debug_free(ptr);
+        return;
     }
+#endif
+    release(ptr);
+}
+
+void free(void* ptr)
+{
+    pthread_mutex_lock(&heap_lock);
+    do_free(ptr);
+    pthread_mutex_unlock(&heap_lock);
 }
 
 void* calloc(size_t nitems, size_t size)
 {
-    size_t total = nitems * size;
+    size_t total;
+    pthread_mutex_lock(&heap_lock);
     registro_calloc++;
+    if (__builtin_mul_overflow(nitems, size, &total))
+    {
+        add_log("calloc", 0, (unsigned int)registro_calloc);
+        pthread_mutex_unlock(&heap_lock);
+        errno = ENOMEM;
+        return NULL;
+    }
     add_log("calloc", total, (unsigned int)registro_calloc);
     // printf("[DEBUG] calloc: nitems=%zu, size=%zu, total=%zu\n", nitems, size, total);
 
-    void* ptr = malloc(total); // reutiliza tu malloc
+    char* zero = NULL;
+    trace_depth++;
+    char* ptr = do_malloc(total, &zero); // reutiliza tu malloc
+    trace_depth--;
+    trace_op(TRACE_CALLOC, total, NULL, ptr);
+    pthread_mutex_unlock(&heap_lock);
     if (!ptr)
     {
         // printf("[DEBUG] calloc: malloc falló\n");
         return NULL;
     }
 
-    memset(ptr, 0, total); // inicializa a cero
+    // Solo se limpia lo que alguna vez se escribio: el resto son paginas
+    // anonimas sin tocar, que el kernel entrega en cero al primer acceso
+    if (zero > ptr + total)
+        zero = ptr + total;
+    memset(ptr, 0, (size_t)(zero - ptr));
+    profile_sample(total);
 
     // printf("[DEBUG] calloc: ptr=%p inicializado a cero\n", ptr);
     return ptr;
 }
 
-void* realloc(void* ptr, size_t size)
+#ifdef MEMORY_DEBUG
+// Con la depuracion el bloque siempre se mueve: el viejo pasa por los chequeos
+// de free y por la cuarentena
+static void* debug_realloc(void* ptr, size_t size)
 {
-    registro_realloc++;
-    add_log("realloc", size, (unsigned int)registro_realloc);
-    // printf("[DEBUG] realloc: ptr=%p, size=%zu\n", ptr, size);
+    size_t old;
+    if (slab_owns(ptr))
+    {
+        old = slab_usable_size(ptr);
+    }
+    else
+    {
+        t_block b = get_block(ptr);
+        if (!block_ok(b) || ((b->head & BLOCK_DEBUG) && (debug_word(b) & DEBUG_QUARANTINED)))
+        {
+            heap_error("realloc de un puntero invalido o ya liberado", ptr, 1);
+            return NULL;
+        }
+        old = (b->head & BLOCK_DEBUG) ? debug_word(b) : block_size(b);
+    }
 
+    void* moved = do_malloc(size, NULL);
+    if (moved)
+    {
+        memcpy(moved, ptr, old < size ? old : size);
+        do_free(ptr);
+    }
+    return moved;
+}
+#endif
+
+static void* reallocate(void* ptr, size_t size)
+{
     if (!ptr)
     {
         // printf("[DEBUG] realloc: ptr NULL, llama a malloc\n");
-        return malloc(size); // caso NULL -> malloc
+        return do_malloc(size, NULL); // caso NULL -> malloc
     }
 
     if (size == 0)
     { // tamaño 0 -> free
-        free(ptr);
+        do_free(ptr);
         // printf("[DEBUG] realloc: size 0, ptr liberado\n");
         return NULL;
     }
 
+#ifdef MEMORY_DEBUG
+    if (debug_flags || (!slab_owns(ptr) && (get_block(ptr)->head & BLOCK_DEBUG)))
+        return debug_realloc(ptr, size);
+#endif
+
+    // Objeto de un slab: sirve mientras entre en su clase, si no se mueve
+    if (slab_owns(ptr))
+    {
+        size_t usable = slab_usable_size(ptr);
+        if (size <= usable)
+            return ptr;
+        void* moved = do_malloc(size, NULL);
+        if (moved)
+        {
+            memcpy(moved, ptr, usable);
+            do_free(ptr);
+        }
+        return moved;
+    }
+
     t_block b = get_block(ptr); // obtiene la cabecera
-    if (!b)
+    if (!block_ok(b))
     {
         // printf("[DEBUG] realloc: no se encontró bloque\n");
         return NULL;
     }
 
-    // printf("[DEBUG] realloc: bloque actual size=%zu\n", b->size);
+    if (size > MAX_REQUEST)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t s = align(size);
+    if (s < MIN_DATA)
+        s = MIN_DATA;
 
-    // Si el bloque actual ya tiene suficiente tamaño
-    if (b->size >= size)
+    // Bloque con mapeo propio: mremap sin copiar
+    if (block_is_mapped(b))
     {
-        // printf("[DEBUG] realloc: tamaño suficiente, retorno original\n");
+        return remap_block(b, s);
+    }
+
+    // Si el bloque actual ya tiene suficiente tamaño se achica en el lugar
+    if (block_size(b) >= s)
+    {
+        used_sub(block_size(b));
+        split_block(b, s);
+        used_add(block_size(b));
         return ptr;
     }
 
-    // Intentar fusionar con el siguiente bloque libre
-    if (b->next && b->next->free && (b->size + sizeof(struct s_block) + b->next->size) >= size)
+    // Intentar crecer sobre el siguiente bloque libre (o la cola de la arena)
+    t_block n = next_block(b);
+    if (block_is_free(n) && (block_size(b) + BLOCK_SIZE + block_size(n)) >= s)
     {
         // printf("[DEBUG] realloc: fusionando con siguiente bloque libre\n");
-        b->size += sizeof(struct s_block) + b->next->size;
-        b->next = b->next->next;
-        if (b->next)
-            b->next->prev = b;
+        used_sub(block_size(b));
+        remove_free(n);
+        set_head(b, block_size(b) + BLOCK_SIZE + block_size(n), 0);
+        split_block(b, s);
+        used_add(block_size(b));
+        mark_written(b);
         return ptr;
     }
 
     // Si no alcanza, malloc nuevo y copia
-    void* new_ptr = malloc(size);
+    void* new_ptr = do_malloc(size, NULL);
     if (!new_ptr)
     {
         // printf("[DEBUG] realloc: malloc nuevo falló\n");
         return NULL;
     }
 
-    memcpy(new_ptr, ptr, b->size); // preserva contenido
-    free(ptr);
+    memcpy(new_ptr, ptr, block_size(b)); // preserva contenido
+    do_free(ptr);
 
     // printf("[DEBUG] realloc: nuevo ptr=%p, contenido copiado, ptr antiguo liberado\n", new_ptr);
     return new_ptr;
 }
 
+void* realloc(void* ptr, size_t size)
+{
+    pthread_mutex_lock(&heap_lock);
+    registro_realloc++;
+    add_log("realloc", size, (unsigned int)registro_realloc);
+    // printf("[DEBUG] realloc: ptr=%p, size=%zu\n", ptr, size);
+
+    trace_depth++;
+    void* new_ptr = reallocate(ptr, size);
+    trace_depth--;
+
+    // Si falla, el bloque original sigue vivo y conserva su id
+    if (new_ptr || size == 0)
+        trace_op(TRACE_REALLOC, size, ptr, new_ptr);
+    pthread_mutex_unlock(&heap_lock);
+    if (new_ptr)
+        profile_sample(size);
+    return new_ptr;
+}
+
+static void* do_memalign(size_t alignment, size_t size)
+{
+    registro_malloc++;
+    add_log("memalign", size, (unsigned int)registro_malloc);
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (size > MAX_REQUEST || alignment > MAX_REQUEST)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    size_t s = align(size);
+#ifdef MEMORY_DEBUG
+    if (debug_flags)
+        s = align(size + DEBUG_TRAILER);
+#endif
+    void* p = alignment <= MALLOC_ALIGN ? allocate(s, NULL) : allocate_aligned(alignment, s);
+#ifdef MEMORY_DEBUG
+    if (p && debug_flags)
+        debug_arm(p, size);
+#endif
+    // El trace guarda solo el tamano: el replay lo re-ejecuta como malloc
+    trace_op(TRACE_MALLOC, size, NULL, p);
+    return p;
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    int saved = errno;
+    pthread_mutex_lock(&heap_lock);
+    void* p = do_memalign(alignment, size);
+    pthread_mutex_unlock(&heap_lock);
+    if (!p)
+    {
+        int err = errno;
+        errno = saved;
+        return err;
+    }
+    profile_sample(size);
+    *memptr = p;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    pthread_mutex_lock(&heap_lock);
+    void* p = do_memalign(alignment, size);
+    pthread_mutex_unlock(&heap_lock);
+    if (p)
+        profile_sample(size);
+    return p;
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    return aligned_alloc(alignment, size);
+}
+
+void* valloc(size_t size)
+{
+    return aligned_alloc(PAGESIZE, size);
+}
+
+void* pvalloc(size_t size)
+{
+    return aligned_alloc(PAGESIZE, size > MAX_REQUEST ? size : page_round(size));
+}
+
+size_t malloc_usable_size(void* ptr)
+{
+    if (!ptr)
+        return 0;
+    if (slab_owns(ptr))
+        return slab_usable_size(ptr);
+
+    t_block b = get_block(ptr);
+    if (!block_ok(b))
+        return 0;
+#ifdef MEMORY_DEBUG
+    // El trailer no se puede usar sin pisar el canario
+    if (b->head & BLOCK_DEBUG)
+        return debug_word(b) & ~DEBUG_QUARANTINED;
+#endif
+    return block_size(b);
+}
+
 void check_heap(void* data)
 {
     if (data == NULL)
@@ -330,92 +1398,276 @@ void check_heap(void* data)
         return;
     }
 
-    t_block block = get_block(data);
+    if (slab_owns(data))
+    {
+        printf("\033[1;33mHeap check\033[0m\n");
+        printf("Slab object: %zu bytes\n", slab_usable_size(data));
+        return;
+    }
 
-    if (block == NULL)
+    if (!valid_addr(data))
     {
         printf("Block is NULL\n");
         return;
     }
 
+    t_block block = get_block(data);
+
     printf("\033[1;33mHeap check\033[0m\n");
-    printf("Size: %zu\n", block->size);
+    printf("Size: %zu\n", block_size(block));
 
-    if (block->next != NULL)
+    t_block next = next_block(block);
+    if (!is_epilogue(next))
     {
-        printf("Next block: %p\n", (void*)(block->next));
+        printf("Next block: %p\n", (void*)next);
     }
     else
     {
         printf("Next block: NULL\n");
     }
 
-    if (block->prev != NULL)
+    if (block->prev_foot != 0)
     {
-        printf("Prev block: %p\n", (void*)(block->prev));
+        printf("Prev block: %p\n", (void*)prev_block(block));
     }
     else
     {
         printf("Prev block: NULL\n");
     }
 
-    printf("Free: %d\n", block->free);
+    printf("Free: %d\n", block_is_free(block));
+    printf("Mapped: %d\n", block_is_mapped(block));
+    printf("Beginning data address: %p\n", (void*)block->data);
+    printf("Last data address: %p\n", (void*)(block->data + block_size(block)));
 
-    if (block->ptr != NULL)
+    // Extension de funcionalidades
+    if (prev_is_free(block) && block_is_free(block))
     {
-        printf("Beginning data address: %p\n", block->ptr);
-        printf("Last data address: %p\n", (void*)((char*)(block->ptr) + block->size));
+        printf("Prev block able for fusion\n");
     }
-    else
+
+    if (block_is_free(next) && block_is_free(block))
     {
-        printf("Data address: NULL\n");
+        printf("Next block able for fusion\n");
     }
 
-    printf("Heap address: %p\n", sbrk(0));
+    if (next->prev_foot != block->head)
+    {
+        printf("Boundary tag does not match the block header\n");
+    }
+}
 
-    // Extension de funcionalidades
-    if (block->prev && block->prev->free && block->free)
+int check_heap_all(void)
+{
+    size_t used = 0;
+    size_t free_bytes = 0;
+    size_t free_blocks = 0;
+    size_t listed = 0;
+    int errors = 0;
+
+    pthread_mutex_lock(&heap_lock);
+    for (t_arena a = arenas; a; a = a->next)
     {
-        printf("Prev block able for fusion");
+        if (a->next && a->next->prev != a)
+        {
+            heap_error("lista de arenas corrupta", a, 0);
+            errors++;
+            break;
+        }
+
+        // Cada bloque tiene que terminar dentro del mapeo y su footer (prev_foot
+        // del siguiente) tiene que repetir la cabecera
+        char* end = (char*)page_floor((uintptr_t)a) + a->size;
+        t_block b = arena_first(a);
+        while (!is_epilogue(b))
+        {
+            t_block n = next_block(b);
+            if ((char*)n->data > end || n->prev_foot != b->head)
+            {
+                heap_error("etiqueta de frontera corrupta", b->data, 0);
+                errors++;
+                break;
+            }
+            if (block_is_free(b))
+            {
+                free_bytes += block_size(b);
+                free_blocks++;
+                if (block_is_free(n))
+                {
+                    heap_error("bloques libres contiguos sin fusionar", b->data, 0);
+                    errors++;
+                }
+            }
+            else
+            {
+                used += block_size(b);
+#ifdef MEMORY_DEBUG
+                const char* error = (b->head & BLOCK_DEBUG) ? debug_block_error(b) : NULL;
+                if (error)
+                {
+                    heap_error(error, b->data, 0);
+                    errors++;
+                }
+#endif
+            }
+            b = n;
+        }
     }
 
-    if (block->next && block->next->free && block->free)
+    // Las listas tienen que tener exactamente los bloques libres del recorrido;
+    // el limite corta un ciclo
+    for (int node = 0; node < MEM_NUMA_NODES; node++)
+    {
+        for (t_block b = free_list[node]; b && listed <= free_blocks; b = free_next(b))
+        {
+            if (!block_is_free(b) || arena_of(b)->node != node)
+            {
+                heap_error("bloque ocupado o de otro nodo en la lista de libres", b->data, 0);
+                errors++;
+            }
+            listed++;
+        }
+    }
+    if (listed != free_blocks)
     {
-        printf("Next block able for fusion");
+        heap_error("la lista de libres no coincide con el heap", NULL, 0);
+        errors++;
     }
+    if (free_bytes != stats.free_bytes || free_blocks != stats.free_blocks ||
+        used != stats.used_bytes - stats.slab_used_bytes)
+    {
+        heap_error("las estadisticas no coinciden con el heap", NULL, 0);
+        errors++;
+    }
+    pthread_mutex_unlock(&heap_lock);
+    return errors;
+}
 
-    if (block->size != align(sizeof(block->data)))
+int set_debug_flags(int flags)
+{
+#ifdef MEMORY_DEBUG
+    pthread_mutex_lock(&heap_lock);
+    debug_flags = flags ? flags | DEBUG_CANARY : 0;
+    if (!(debug_flags & DEBUG_QUARANTINE))
     {
-        printf("Real block size does not match with the theoretical one");
+        while (quarantine_count)
+            quarantine_evict();
     }
+    pthread_mutex_unlock(&heap_lock);
+    return 0;
+#else
+    return flags ? -1 : 0;
+#endif
+}
+
+void set_debug_handler(void (*handler)(const char* error, void* ptr))
+{
+    pthread_mutex_lock(&heap_lock);
+    error_handler = handler;
+    pthread_mutex_unlock(&heap_lock);
 }
 
 void memory_usage()
 {
-    // Se recorre la lista de bloques, se identifica los bloques libres y ocupados y se suman sus tamaños
-    t_block b = base;
-    size_t freem = 0;
-    size_t usedm = 0;
+    // Los totales se mantienen en cada operacion, no hace falta recorrer el heap
+    printf("Total used memory: %zu bytes\n", stats.used_bytes);
+    printf("Total free memory: %zu bytes\n", stats.free_bytes);
+}
 
-    while (b)
+void memory_stats(t_mem_stats* st)
+{
+    pthread_mutex_lock(&heap_lock);
+    stats.largest_free = 0;
+    for (int node = 0; node < MEM_NUMA_NODES; node++)
     {
-        if (b->free)
-        {
-            freem += b->size;
-        }
-        else
-        {
-            usedm += b->size;
-        }
-        b = b->next;
+        t_block largest = tree_max(&free_tree[node]);
+        if (largest && block_size(largest) > stats.largest_free)
+            stats.largest_free = block_size(largest);
     }
+    stats.numa_nodes = (size_t)online_nodes();
 
-    printf("Total used memory: %zu bytes\n", usedm);
-    printf("Total free memory: %zu bytes\n", freem);
+    *st = stats;
+    st->slab_bytes = slab_committed();
+    st->fragmentation =
+        stats.free_bytes ? (double)(stats.free_bytes - stats.largest_free) / (double)stats.free_bytes : 0.0;
+    pthread_mutex_unlock(&heap_lock);
+}
+
+// Un fork con el lock tomado por otro hilo dejaria al hijo sin heap: se toman
+// los locks antes del fork (el del perfilador primero, porque quien lo tiene
+// puede pedir memoria) y se liberan en los dos procesos.
+static void fork_prepare(void)
+{
+    profile_fork_prepare();
+    pthread_mutex_lock(&heap_lock);
+}
+
+static void fork_parent(void)
+{
+    pthread_mutex_unlock(&heap_lock);
+    profile_fork_parent();
+}
+
+// El archivo y el buffer del trace los usa trace_record con el lock tomado
+int trace_open(const char* path)
+{
+    pthread_mutex_lock(&heap_lock);
+    int st = trace_start(path);
+    pthread_mutex_unlock(&heap_lock);
+    return st;
+}
+
+void trace_close(void)
+{
+    pthread_mutex_lock(&heap_lock);
+    trace_stop();
+    pthread_mutex_unlock(&heap_lock);
+}
+
+static void fork_child(void)
+{
+    trace_fork_child();
+    pthread_mutex_unlock(&heap_lock);
+    profile_fork_child();
+}
+
+// El heap no necesita inicializacion (todo el estado arranca en cero), asi que
+// malloc funciona aunque se llame antes de este constructor.
+__attribute__((constructor)) static void register_fork_handlers(void)
+{
+    pthread_atfork(fork_prepare, fork_parent, fork_child);
+}
+
+// Permite activar las paginas grandes sin recompilar: MEMORY_HUGE_PAGES=1
+__attribute__((constructor)) static void huge_pages_from_env(void)
+{
+    const char* v = getenv(HUGE_PAGES_ENV);
+    if (v && *v && *v != '0')
+        set_huge_pages(1);
+}
+
+#ifdef MEMORY_DEBUG
+// Depuracion sin recompilar el programa: MEMORY_DEBUG_FLAGS=<flags>
+__attribute__((constructor)) static void debug_from_env(void)
+{
+    const char* v = getenv(DEBUG_ENV);
+    if (v && *v)
+        set_debug_flags((int)strtol(v, NULL, 0));
+}
+#endif
+
+int set_log_enabled(int enabled)
+{
+    int previous = log_enabled;
+    log_enabled = enabled;
+    return previous;
 }
 
 void add_log(const char* op, size_t size, unsigned int counter)
 {
+    if (!log_enabled)
+        return;
+
     t_log_entry* new_log = mmap(NULL, sizeof(t_log_entry), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
     if (new_log == MAP_FAILED)
         return;
@@ -461,5 +1713,10 @@ void memory_usage_stats()
     printf("Calloc calls  : %d\n", registro_calloc);
     printf("Realloc calls : %d\n", registro_realloc);
     memory_usage();
+
+    t_mem_stats st;
+    memory_stats(&st);
+    printf("Largest free block: %zu bytes\n", st.largest_free);
+    printf("External fragmentation: %.2f%%\n", st.fragmentation * 100.0);
 }
 
@@ -0,0 +1,232 @@
+#include <profile.h>
+
+#include <execinfo.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/** Marcos propios que se descartan del backtrace: profile_sample y malloc. */
+#define PROFILE_SKIP 2
+
+/**
+ * @struct s_profile_site
+ * @brief Punto de llamada: su pila y lo que se muestreo desde ahi.
+ */
+struct s_profile_site
+{
+    uint64_t hash;
+    uint64_t samples;
+    uint64_t bytes;
+    int depth; /**< 0: slot vacio */
+    void* frames[PROFILE_DEPTH];
+};
+
+// Se pide con mmap para no depender del propio allocator
+static struct s_profile_site* sites = NULL;
+static size_t sites_used = 0;
+static uint64_t dropped = 0; // muestras que no entraron en la tabla
+static size_t rate = 0;
+static pthread_mutex_t profile_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Estado por hilo. initial-exec evita que el acceso a la TLS pida memoria
+// cuando la libreria se carga con LD_PRELOAD.
+static __thread size_t pending __attribute__((tls_model("initial-exec"))) = 0;
+static __thread int in_profile __attribute__((tls_model("initial-exec"))) = 0;
+
+static uint64_t hash_frames(void** frames, int depth)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (int i = 0; i < depth; i++)
+        h = (h ^ (uint64_t)(uintptr_t)frames[i]) * 0x100000001B3ULL;
+    return h;
+}
+
+static void record(void** frames, int depth, uint64_t bytes)
+{
+    uint64_t h = hash_frames(frames, depth);
+
+    pthread_mutex_lock(&profile_lock);
+    size_t i = (size_t)(h >> 16) & (PROFILE_SITES - 1);
+    while (sites[i].depth != 0 &&
+           (sites[i].hash != h || sites[i].depth != depth ||
+            memcmp(sites[i].frames, frames, (size_t)depth * sizeof(void*)) != 0))
+        i = (i + 1) & (PROFILE_SITES - 1);
+
+    if (sites[i].depth == 0)
+    {
+        // Se deja un cuarto libre para que el sondeo siga siendo corto
+        if ((sites_used + 1) * 4 > PROFILE_SITES * 3)
+        {
+            dropped++;
+            pthread_mutex_unlock(&profile_lock);
+            return;
+        }
+        sites[i].hash = h;
+        sites[i].depth = depth;
+        memcpy(sites[i].frames, frames, (size_t)depth * sizeof(void*));
+        sites_used++;
+    }
+    sites[i].samples++;
+    sites[i].bytes += bytes;
+    pthread_mutex_unlock(&profile_lock);
+}
+
+void profile_sample(size_t size)
+{
+    size_t r = rate;
+    if (r == 0 || in_profile)
+        return;
+
+    pending += size;
+    if (pending < r)
+        return;
+
+    // La muestra representa todos los intervalos que cruzo el pedido
+    uint64_t bytes = (uint64_t)(pending / r) * r;
+    pending %= r;
+
+    // backtrace() carga libgcc_s la primera vez y eso vuelve a llamar a malloc
+    in_profile = 1;
+    void* frames[PROFILE_DEPTH + PROFILE_SKIP];
+    int depth = backtrace(frames, PROFILE_DEPTH + PROFILE_SKIP) - PROFILE_SKIP;
+    if (depth > 0)
+        record(frames + PROFILE_SKIP, depth, bytes);
+    in_profile = 0;
+}
+
+int profile_set_rate(size_t r)
+{
+    if (r && !sites)
+    {
+        void* p = mmap(NULL, PROFILE_SITES * sizeof(struct s_profile_site), PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            return -1;
+        sites = p;
+
+        // Primer backtrace fuera de un pedido para cargar el desenrollador
+        void* frame;
+        in_profile = 1;
+        backtrace(&frame, 1);
+        in_profile = 0;
+    }
+    rate = r;
+    return 0;
+}
+
+size_t profile_get_rate(void)
+{
+    return rate;
+}
+
+void profile_reset(void)
+{
+    pthread_mutex_lock(&profile_lock);
+    if (sites)
+        memset(sites, 0, PROFILE_SITES * sizeof(struct s_profile_site));
+    sites_used = 0;
+    dropped = 0;
+    pthread_mutex_unlock(&profile_lock);
+}
+
+static int by_bytes(const void* a, const void* b)
+{
+    const struct s_profile_site* x = *(const struct s_profile_site* const*)a;
+    const struct s_profile_site* y = *(const struct s_profile_site* const*)b;
+    return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
+
+static int put_line(int fd, const char* line, int len)
+{
+    return len > 0 && write(fd, line, (size_t)len) == (ssize_t)len ? 0 : -1;
+}
+
+int profile_dump(int fd)
+{
+    static struct s_profile_site* order[PROFILE_SITES];
+    char line[128];
+    uint64_t samples = 0;
+    int n = 0;
+
+    pthread_mutex_lock(&profile_lock);
+    if (!sites)
+    {
+        pthread_mutex_unlock(&profile_lock);
+        return -1;
+    }
+    for (size_t i = 0; i < PROFILE_SITES; i++)
+    {
+        if (sites[i].depth == 0)
+            continue;
+        order[n++] = &sites[i];
+        samples += sites[i].samples;
+    }
+
+    in_profile = 1;
+    qsort(order, (size_t)n, sizeof(order[0]), by_bytes);
+
+    int len = snprintf(line, sizeof(line), "# MemoryLib profile: rate %zu, %llu samples, %d sites, %llu dropped\n",
+                       rate, (unsigned long long)samples, n, (unsigned long long)dropped);
+    int ok = put_line(fd, line, len) == 0;
+    for (int i = 0; ok && i < n; i++)
+    {
+        len = snprintf(line, sizeof(line), "site %d: %llu samples, %llu bytes\n", i + 1,
+                       (unsigned long long)order[i]->samples, (unsigned long long)order[i]->bytes);
+        if (put_line(fd, line, len) != 0)
+            break;
+        // Escribe un simbolo por linea sin pedir memoria
+        backtrace_symbols_fd(order[i]->frames, order[i]->depth, fd);
+    }
+    in_profile = 0;
+    pthread_mutex_unlock(&profile_lock);
+    return n;
+}
+
+void profile_fork_prepare(void)
+{
+    pthread_mutex_lock(&profile_lock);
+}
+
+void profile_fork_parent(void)
+{
+    pthread_mutex_unlock(&profile_lock);
+}
+
+void profile_fork_child(void)
+{
+    pthread_mutex_unlock(&profile_lock);
+    profile_reset();
+}
+
+// Permite perfilar un proceso sin recompilarlo: MEMORY_PROFILE_RATE=<bytes>
+__attribute__((constructor)) static void profile_from_env(void)
+{
+    const char* r = getenv(PROFILE_ENV);
+    if (r && *r)
+        profile_set_rate(strtoull(r, NULL, 10));
+}
+
+__attribute__((destructor)) static void profile_at_exit(void)
+{
+    if (!sites || !sites_used)
+        return;
+
+    const char* path = getenv(PROFILE_FILE_ENV);
+    int fd = STDERR_FILENO;
+    if (path && *path)
+    {
+        // Un archivo por proceso: los hijos de fork vuelcan lo suyo aparte
+        char name[4096];
+        snprintf(name, sizeof(name), "%s.%d", path, (int)getpid());
+        fd = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return;
+    }
+    profile_dump(fd);
+    if (fd != STDERR_FILENO)
+        close(fd);
+}
@@ -0,0 +1,123 @@
+#include <memory.h>
+
+#include <errno.h>
+
+/** Pedidos de mas de chunk_size / SCOPE_LARGE_DIV reciben un chunk propio. */
+#define SCOPE_LARGE_DIV 4
+
+/**
+ * @struct s_scope_chunk
+ * @brief Chunk pedido al heap; los datos empiezan alineados a MALLOC_ALIGN.
+ */
+struct s_scope_chunk
+{
+    struct s_scope_chunk* next;
+    size_t size;
+};
+
+/**
+ * @struct s_scope
+ * @brief Scope de asignaciones: se avanza `cur` hasta `end` en el chunk actual.
+ *
+ * El primer chunk se pide junto con el scope y se conserva en scope_reset; los
+ * demas quedan enlazados en `chunks` hasta el reset.
+ */
+struct s_scope
+{
+    struct s_scope_chunk* chunks;
+    char* cur;
+    char* end;
+    size_t chunk_size;
+};
+
+#define SCOPE_HEADER align(sizeof(struct s_scope))
+#define CHUNK_HEADER align(sizeof(struct s_scope_chunk))
+#define chunk_data(c) ((char*)(c) + CHUNK_HEADER)
+
+// Datos del chunk que viene pegado al scope
+#define first_data(s) ((char*)(s) + SCOPE_HEADER)
+
+t_scope scope_create(size_t chunk_size)
+{
+    if (chunk_size == 0)
+        chunk_size = SCOPE_CHUNK_SIZE;
+    chunk_size = align(chunk_size);
+    if (chunk_size > MAX_REQUEST)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    t_scope s = malloc(SCOPE_HEADER + chunk_size);
+    if (!s)
+        return NULL;
+    s->chunks = NULL;
+    s->chunk_size = chunk_size;
+    s->cur = first_data(s);
+    s->end = s->cur + chunk_size;
+    return s;
+}
+
+static struct s_scope_chunk* new_chunk(t_scope s, size_t size)
+{
+    struct s_scope_chunk* c = malloc(CHUNK_HEADER + size);
+    if (!c)
+        return NULL;
+    c->size = size;
+    c->next = s->chunks;
+    s->chunks = c;
+    return c;
+}
+
+void* scope_alloc(t_scope s, size_t size)
+{
+    if (size > MAX_REQUEST)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size = align(size);
+
+    if (size <= (size_t)(s->end - s->cur))
+    {
+        void* p = s->cur;
+        s->cur += size;
+        return p;
+    }
+
+    // Un pedido grande no descarta lo que queda del chunk actual
+    if (size > s->chunk_size / SCOPE_LARGE_DIV)
+    {
+        struct s_scope_chunk* c = new_chunk(s, size);
+        return c ? chunk_data(c) : NULL;
+    }
+
+    struct s_scope_chunk* c = new_chunk(s, s->chunk_size);
+    if (!c)
+        return NULL;
+    s->cur = chunk_data(c) + size;
+    s->end = chunk_data(c) + s->chunk_size;
+    return chunk_data(c);
+}
+
+void scope_reset(t_scope s)
+{
+    struct s_scope_chunk* c = s->chunks;
+    while (c)
+    {
+        struct s_scope_chunk* next = c->next;
+        free(c);
+        c = next;
+    }
+    s->chunks = NULL;
+    s->cur = first_data(s);
+    s->end = s->cur + s->chunk_size;
+}
+
+void scope_destroy(t_scope s)
+{
+    if (!s)
+        return;
+    scope_reset(s);
+    free(s);
+}
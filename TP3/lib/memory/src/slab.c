@@ -0,0 +1,194 @@
+#include <slab.h>
+
+#include <string.h>
+#include <sys/mman.h>
+
+// Region reservada sin permisos; se habilita de a SLAB_COMMIT bytes
+static char* region = NULL;
+static char* region_top = NULL;       // proxima pagina sin usar
+static char* region_committed = NULL; // fin de la zona con permiso de escritura
+static int region_failed = 0;
+
+// Slabs con objetos libres por clase
+static t_slab partial[SLAB_CLASSES];
+
+// Paginas de slabs vacios: un bit por pagina de la region. El pool vive fuera
+// de las paginas para poder liberarlas con madvise sin perderlas.
+#define REGION_PAGES (SLAB_REGION_SIZE / SLAB_SIZE)
+static uint64_t empty_map[REGION_PAGES / 64];
+static uint64_t clean_map[REGION_PAGES / 64]; // vacias ya devueltas con madvise
+static size_t empty_count = 0;
+static size_t empty_hint = 0; // ninguna palabra anterior tiene bits en 1
+
+static const uint16_t class_size[SLAB_CLASSES] = {16,  32,  48,  64,  80,  96,  112, 128,
+                                                  160, 192, 224, 256, 320, 384, 448, 512};
+
+static int slab_class(size_t size)
+{
+    if (size <= 128)
+        return size ? (int)((size - 1) >> 4) : 0;
+    if (size <= 256)
+        return 8 + (int)((size - 129) >> 5);
+    return 12 + (int)((size - 257) >> 6);
+}
+
+#define slab_of(p) ((t_slab)((uintptr_t)(p) & ~(uintptr_t)(SLAB_SIZE - 1)))
+#define slab_objs(s) ((char*)(s) + SLAB_HEADER)
+
+static void partial_push(t_slab s)
+{
+    s->prev = NULL;
+    s->next = partial[s->cls];
+    if (s->next)
+        s->next->prev = s;
+    partial[s->cls] = s;
+}
+
+static void partial_remove(t_slab s)
+{
+    if (s->prev)
+        s->prev->next = s->next;
+    else
+        partial[s->cls] = s->next;
+    if (s->next)
+        s->next->prev = s->prev;
+}
+
+// Toma una pagina vacia o la siguiente de la region, habilitandola si hace falta
+static t_slab page_get(void)
+{
+    if (empty_count)
+    {
+        while (!empty_map[empty_hint])
+            empty_hint++;
+        size_t page = (empty_hint << 6) + (size_t)__builtin_ctzll(empty_map[empty_hint]);
+        empty_map[empty_hint] &= empty_map[empty_hint] - 1;
+        clean_map[page >> 6] &= ~((uint64_t)1 << (page & 63));
+        empty_count--;
+        return (t_slab)(region + page * SLAB_SIZE);
+    }
+
+    if (!region)
+    {
+        if (region_failed)
+            return NULL;
+        void* r = mmap(NULL, SLAB_REGION_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (r == MAP_FAILED)
+        {
+            region_failed = 1;
+            return NULL;
+        }
+        region = region_top = region_committed = r;
+    }
+
+    if (region_top == region_committed)
+    {
+        if (region_committed == region + SLAB_REGION_SIZE ||
+            mprotect(region_committed, SLAB_COMMIT, PROT_READ | PROT_WRITE) != 0)
+            return NULL;
+        region_committed += SLAB_COMMIT;
+    }
+
+    t_slab s = (t_slab)region_top;
+    region_top += SLAB_SIZE;
+    return s;
+}
+
+static t_slab slab_new(int cls)
+{
+    t_slab s = page_get();
+    if (!s)
+        return NULL;
+
+    s->size = class_size[cls];
+    s->cls = (uint16_t)cls;
+    s->count = (uint16_t)((SLAB_SIZE - SLAB_HEADER) / s->size);
+    s->nfree = s->count;
+    memset(s->map, 0, sizeof(s->map));
+    for (int i = 0; i < s->count; i++)
+        s->map[i >> 6] |= (uint64_t)1 << (i & 63);
+
+    partial_push(s);
+    return s;
+}
+
+void* slab_alloc(size_t size)
+{
+    int cls = slab_class(size);
+    t_slab s = partial[cls];
+    if (!s && !(s = slab_new(cls)))
+        return NULL;
+
+    int w = 0;
+    while (!s->map[w])
+        w++;
+    int i = (w << 6) + __builtin_ctzll(s->map[w]);
+    s->map[w] &= s->map[w] - 1;
+
+    if (--s->nfree == 0)
+        partial_remove(s);
+    return slab_objs(s) + (size_t)i * s->size;
+}
+
+size_t slab_free(void* p)
+{
+    t_slab s = slab_of(p);
+    if ((char*)p < slab_objs(s) || s->size == 0)
+        return 0; // cabecera, o pagina vacia devuelta al sistema
+
+    size_t off = (size_t)((char*)p - slab_objs(s));
+    size_t i = off / s->size;
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    if (off % s->size != 0 || i >= s->count || (s->map[i >> 6] & bit))
+        return 0; // no es un objeto, o ya estaba libre
+
+    s->map[i >> 6] |= bit;
+    s->nfree++;
+    if (s->nfree == 1)
+        partial_push(s);
+    else if (s->nfree == s->count && (partial[s->cls] != s || s->next))
+    {
+        // Vacio y no es el unico de su clase: la pagina vuelve al pool
+        size_t page = (size_t)((char*)s - region) / SLAB_SIZE;
+        partial_remove(s);
+        empty_map[page >> 6] |= (uint64_t)1 << (page & 63);
+        empty_count++;
+        if ((page >> 6) < empty_hint)
+            empty_hint = page >> 6;
+    }
+    return s->size;
+}
+
+int slab_owns(const void* p)
+{
+    return (const char*)p >= region && (const char*)p < region_top;
+}
+
+size_t slab_usable_size(const void* p)
+{
+    return slab_of(p)->size;
+}
+
+size_t slab_trim(void)
+{
+    // Las paginas quedan en el pool: al reutilizarlas se vuelven a pedir en cero
+    size_t released = 0;
+    size_t words = (size_t)(region_top - region) / SLAB_SIZE / 64 + 1;
+    for (size_t w = empty_hint; empty_count && w < words && w < REGION_PAGES / 64; w++)
+    {
+        uint64_t dirty = empty_map[w] & ~clean_map[w];
+        clean_map[w] |= dirty;
+        for (uint64_t m = dirty; m; m &= m - 1)
+        {
+            char* page = region + ((w << 6) + (size_t)__builtin_ctzll(m)) * SLAB_SIZE;
+            if (madvise(page, SLAB_SIZE, MADV_DONTNEED) == 0)
+                released += SLAB_SIZE;
+        }
+    }
+    return released;
+}
+
+size_t slab_committed(void)
+{
+    return (size_t)(region_committed - region);
+}
@@ -0,0 +1,117 @@
+#include <memory.h>
+
+#include <stdarg.h>
+
+/**
+ * @struct s_out
+ * @brief Buffer de salida que acumula texto como snprintf sin pasarse del largo.
+ */
+struct s_out
+{
+    char* buf;
+    size_t len;
+    size_t pos;
+};
+
+static void out_printf(struct s_out* o, const char* fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    size_t room = o->pos < o->len ? o->len - o->pos : 0;
+    int n = vsnprintf(room ? o->buf + o->pos : NULL, room, fmt, ap);
+    va_end(ap);
+    if (n > 0)
+        o->pos += (size_t)n;
+}
+
+static void json_array(struct s_out* o, const char* name, const size_t* v)
+{
+    out_printf(o, "\"%s\":[", name);
+    for (int i = 0; i < MEM_SIZE_CLASSES; i++)
+        out_printf(o, i ? ",%zu" : "%zu", v[i]);
+    out_printf(o, "],");
+}
+
+int memory_stats_json(char* buf, size_t len)
+{
+    t_mem_stats st;
+    struct s_out o = {buf, len, 0};
+    memory_stats(&st);
+
+    out_printf(&o, "{\"used_bytes\":%zu,\"free_bytes\":%zu,", st.used_bytes, st.free_bytes);
+    out_printf(&o, "\"used_blocks\":%zu,\"free_blocks\":%zu,", st.used_blocks, st.free_blocks);
+    json_array(&o, "used_by_class", st.used_by_class);
+    json_array(&o, "free_by_class", st.free_by_class);
+    out_printf(&o, "\"largest_free\":%zu,\"fragmentation\":%.6f,", st.largest_free, st.fragmentation);
+    out_printf(&o, "\"arena_count\":%zu,\"mapped_blocks\":%zu,\"mapped_bytes\":%zu,", st.arena_count,
+               st.mapped_blocks, st.mapped_bytes);
+    out_printf(&o, "\"released_bytes\":%zu,", st.released_bytes);
+    out_printf(&o, "\"slab_used_bytes\":%zu,\"slab_bytes\":%zu,", st.slab_used_bytes, st.slab_bytes);
+    out_printf(&o, "\"numa_nodes\":%zu,\"remote_frees\":%zu,", st.numa_nodes, st.remote_frees);
+    out_printf(&o, "\"huge_bytes\":%zu,\"hugetlb_bytes\":%zu,\"huge_pool_bytes\":%zu,", st.huge_bytes,
+               st.hugetlb_bytes, st.huge_pool_bytes);
+    out_printf(&o, "\"calls\":{\"malloc\":%d,\"free\":%d,\"calloc\":%d,\"realloc\":%d}}", registro_malloc,
+               registro_free, registro_calloc, registro_realloc);
+
+    if (len && o.pos >= len)
+        buf[len - 1] = '\0';
+    return (int)o.pos;
+}
+
+static void prom_gauge(struct s_out* o, const char* name, const char* help, double value)
+{
+    out_printf(o, "# HELP %s %s\n# TYPE %s gauge\n%s %.17g\n", name, help, name, name, value);
+}
+
+static void prom_classes(struct s_out* o, const char* state, const size_t* v)
+{
+    for (int i = 0; i < MEM_SIZE_CLASSES; i++)
+    {
+        // Limite inferior de la clase en bytes
+        out_printf(o, "allocator_blocks{state=\"%s\",class=\"%zu\"} %zu\n", state, (size_t)1 << (i + MEM_CLASS_SHIFT), v[i]);
+    }
+}
+
+int memory_stats_prometheus(char* buf, size_t len)
+{
+    t_mem_stats st;
+    struct s_out o = {buf, len, 0};
+    memory_stats(&st);
+
+    prom_gauge(&o, "allocator_used_bytes", "Bytes de datos en bloques ocupados", (double)st.used_bytes);
+    prom_gauge(&o, "allocator_free_bytes", "Bytes de datos en bloques libres", (double)st.free_bytes);
+    prom_gauge(&o, "allocator_largest_free_bytes", "Tamano del mayor bloque libre", (double)st.largest_free);
+    prom_gauge(&o, "allocator_fragmentation_ratio", "Fragmentacion externa del heap", st.fragmentation);
+    prom_gauge(&o, "allocator_arenas", "Arenas de bloques chicos", (double)st.arena_count);
+    prom_gauge(&o, "allocator_mapped_blocks", "Bloques con mapeo propio", (double)st.mapped_blocks);
+    prom_gauge(&o, "allocator_mapped_bytes", "Bytes pedidos al sistema", (double)st.mapped_bytes);
+    prom_gauge(&o, "allocator_slab_used_bytes", "Bytes de objetos ocupados en slabs", (double)st.slab_used_bytes);
+    prom_gauge(&o, "allocator_slab_bytes", "Bytes habilitados para slabs", (double)st.slab_bytes);
+    prom_gauge(&o, "allocator_numa_nodes", "Nodos NUMA en linea", (double)st.numa_nodes);
+    prom_gauge(&o, "allocator_huge_bytes", "Bytes mapeados con paginas grandes", (double)st.huge_bytes);
+    prom_gauge(&o, "allocator_hugetlb_bytes", "Bytes de paginas grandes de MAP_HUGETLB", (double)st.hugetlb_bytes);
+    prom_gauge(&o, "allocator_huge_pool_bytes", "Arenas sin usar en chunks de paginas grandes",
+               (double)st.huge_pool_bytes);
+
+    out_printf(&o, "# HELP allocator_blocks Bloques por estado y clase de tamano\n# TYPE allocator_blocks gauge\n");
+    prom_classes(&o, "used", st.used_by_class);
+    prom_classes(&o, "free", st.free_by_class);
+
+    out_printf(&o, "# HELP allocator_released_bytes_total Bytes devueltos al sistema con madvise\n"
+                   "# TYPE allocator_released_bytes_total counter\n");
+    out_printf(&o, "allocator_released_bytes_total %zu\n", st.released_bytes);
+
+    out_printf(&o, "# HELP allocator_remote_frees_total Bloques liberados desde otro nodo NUMA\n"
+                   "# TYPE allocator_remote_frees_total counter\n");
+    out_printf(&o, "allocator_remote_frees_total %zu\n", st.remote_frees);
+
+    out_printf(&o, "# HELP allocator_calls_total Llamadas por operacion\n# TYPE allocator_calls_total counter\n");
+    out_printf(&o, "allocator_calls_total{op=\"malloc\"} %d\n", registro_malloc);
+    out_printf(&o, "allocator_calls_total{op=\"free\"} %d\n", registro_free);
+    out_printf(&o, "allocator_calls_total{op=\"calloc\"} %d\n", registro_calloc);
+    out_printf(&o, "allocator_calls_total{op=\"realloc\"} %d\n", registro_realloc);
+
+    if (len && o.pos >= len)
+        buf[len - 1] = '\0';
+    return (int)o.pos;
+}
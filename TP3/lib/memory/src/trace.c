@@ -0,0 +1,471 @@
+#define _GNU_SOURCE // mremap
+
+#include <trace.h>
+
+#include <memory.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/** Capacidad inicial de la tabla de ids (potencia de 2). */
+#define TRACE_IDS_INITIAL 4096
+/** Capacidad inicial de la tabla id -> direccion del replay. */
+#define REPLAY_IDS_INITIAL 65536
+/** Marca de slot vacio en la tabla de ids. */
+#define TRACE_EMPTY 0
+
+/**
+ * @struct s_trace_slot
+ * @brief Asociacion direccion -> id dentro de la tabla de hash.
+ */
+struct s_trace_slot
+{
+    uintptr_t addr;
+    uint64_t id;
+};
+
+static int trace_fd = -1;
+static char trace_path[TRACE_PATH_MAX]; // Para abrir el trace de los hijos de fork
+static uint8_t trace_buf[TRACE_BUFFER_SIZE];
+static size_t trace_len = 0;
+static uint64_t trace_last_ns = 0;
+static uint64_t trace_next_id = 1;
+
+// Hilo que esta re-ejecutando un trace: sus operaciones no se capturan
+static __thread int trace_replaying __attribute__((tls_model("initial-exec"))) = 0;
+
+// Tabla de hash con direccionamiento abierto y sondeo lineal. Se pide con mmap
+// para no depender del propio allocator mientras se captura.
+static struct s_trace_slot* ids = NULL;
+static size_t ids_cap = 0;
+static size_t ids_used = 0;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static size_t slot_of(uintptr_t addr, size_t cap)
+{
+    return (size_t)(((uint64_t)addr * 0x9E3779B97F4A7C15ULL) >> 16) & (cap - 1);
+}
+
+static struct s_trace_slot* ids_alloc(size_t cap)
+{
+    void* p = mmap(NULL, cap * sizeof(struct s_trace_slot), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : (struct s_trace_slot*)p;
+}
+
+static void ids_release(void)
+{
+    if (ids)
+        munmap(ids, ids_cap * sizeof(struct s_trace_slot));
+    ids = NULL;
+    ids_cap = 0;
+    ids_used = 0;
+}
+
+static int ids_grow(void)
+{
+    size_t cap = ids_cap ? ids_cap * 2 : TRACE_IDS_INITIAL;
+    struct s_trace_slot* table = ids_alloc(cap);
+    if (!table)
+        return -1;
+
+    for (size_t i = 0; i < ids_cap; i++)
+    {
+        if (ids[i].addr == TRACE_EMPTY)
+            continue;
+        size_t j = slot_of(ids[i].addr, cap);
+        while (table[j].addr != TRACE_EMPTY)
+            j = (j + 1) & (cap - 1);
+        table[j] = ids[i];
+    }
+
+    size_t used = ids_used;
+    ids_release();
+    ids = table;
+    ids_cap = cap;
+    ids_used = used;
+    return 0;
+}
+
+static uint64_t ids_insert(void* p)
+{
+    if (!p)
+        return 0;
+    if ((ids_used + 1) * 2 > ids_cap && ids_grow() != 0)
+        return 0;
+
+    uintptr_t addr = (uintptr_t)p;
+    size_t i = slot_of(addr, ids_cap);
+    while (ids[i].addr != TRACE_EMPTY && ids[i].addr != addr)
+        i = (i + 1) & (ids_cap - 1);
+
+    if (ids[i].addr == TRACE_EMPTY)
+        ids_used++;
+    ids[i].addr = addr;
+    ids[i].id = trace_next_id++;
+    return ids[i].id;
+}
+
+static uint64_t ids_remove(void* p)
+{
+    if (!p || !ids)
+        return 0;
+
+    uintptr_t addr = (uintptr_t)p;
+    size_t i = slot_of(addr, ids_cap);
+    while (ids[i].addr != addr)
+    {
+        if (ids[i].addr == TRACE_EMPTY)
+            return 0;
+        i = (i + 1) & (ids_cap - 1);
+    }
+    uint64_t id = ids[i].id;
+
+    // Borrado con corrimiento hacia atras para no dejar huecos en las cadenas de sondeo
+    size_t hole = i;
+    size_t j = i;
+    while (1)
+    {
+        j = (j + 1) & (ids_cap - 1);
+        if (ids[j].addr == TRACE_EMPTY)
+            break;
+        size_t home = slot_of(ids[j].addr, ids_cap);
+        if (((j - home) & (ids_cap - 1)) >= ((j - hole) & (ids_cap - 1)))
+        {
+            ids[hole] = ids[j];
+            hole = j;
+        }
+    }
+    ids[hole].addr = TRACE_EMPTY;
+    ids_used--;
+    return id;
+}
+
+static void trace_flush(void)
+{
+    size_t done = 0;
+    while (done < trace_len)
+    {
+        ssize_t w = write(trace_fd, trace_buf + done, trace_len - done);
+        if (w <= 0)
+            break;
+        done += (size_t)w;
+    }
+    trace_len = 0;
+}
+
+static void trace_put(uint64_t v)
+{
+    trace_len += trace_encode_varint(trace_buf + trace_len, v);
+}
+
+size_t trace_encode_varint(uint8_t* buf, uint64_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80)
+    {
+        buf[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = (uint8_t)v;
+    return n;
+}
+
+size_t trace_decode_varint(const uint8_t* buf, size_t len, uint64_t* v)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < len && i < TRACE_VARINT_MAX; i++)
+    {
+        result |= (uint64_t)(buf[i] & 0x7F) << (7 * i);
+        if (!(buf[i] & 0x80))
+        {
+            *v = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+int trace_start(const char* path)
+{
+    if (trace_fd >= 0)
+        trace_stop();
+
+    trace_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (trace_fd < 0)
+        return -1;
+    snprintf(trace_path, sizeof(trace_path), "%s", path);
+
+    memcpy(trace_buf, TRACE_MAGIC, TRACE_MAGIC_LEN);
+    trace_buf[TRACE_MAGIC_LEN] = TRACE_VERSION;
+    trace_len = TRACE_MAGIC_LEN + 1;
+    trace_next_id = 1;
+    trace_last_ns = now_ns();
+    return 0;
+}
+
+void trace_stop(void)
+{
+    if (trace_fd < 0)
+        return;
+    trace_flush();
+    close(trace_fd);
+    trace_fd = -1;
+    ids_release();
+}
+
+void trace_fork_child(void)
+{
+    if (trace_fd < 0)
+        return;
+
+    // Lo que quedo en el buffer lo escribe el padre, y los ids son los suyos
+    trace_len = 0;
+    close(trace_fd);
+    trace_fd = -1;
+    ids_release();
+
+    // El hijo sigue en su propio archivo: dos procesos no pueden intercalar
+    // registros en uno solo
+    char name[TRACE_PATH_MAX + 16];
+    snprintf(name, sizeof(name), "%s.%d", trace_path, (int)getpid());
+    trace_start(name);
+}
+
+int trace_enabled(void)
+{
+    return trace_fd >= 0 && !trace_replaying;
+}
+
+void trace_record(int op, size_t size, void* in, void* out)
+{
+    if (trace_fd < 0)
+        return;
+
+    // Peor caso de un registro: op + 4 varints
+    if (trace_len + 1 + 4 * TRACE_VARINT_MAX > TRACE_BUFFER_SIZE)
+        trace_flush();
+
+    uint64_t now = now_ns();
+    trace_buf[trace_len++] = (uint8_t)op;
+    trace_put(now - trace_last_ns);
+    trace_last_ns = now;
+
+    switch (op)
+    {
+    case TRACE_MALLOC:
+    case TRACE_CALLOC:
+        trace_put(size);
+        trace_put(ids_insert(out));
+        break;
+    case TRACE_FREE:
+        trace_put(ids_remove(in));
+        break;
+    case TRACE_REALLOC:
+        trace_put(ids_remove(in));
+        trace_put(size);
+        trace_put(ids_insert(out));
+        break;
+    default:
+        break;
+    }
+}
+
+size_t trace_check_header(const uint8_t* buf, size_t len)
+{
+    if (len < TRACE_MAGIC_LEN + 1 || memcmp(buf, TRACE_MAGIC, TRACE_MAGIC_LEN) != 0 ||
+        buf[TRACE_MAGIC_LEN] != TRACE_VERSION)
+        return 0;
+    return TRACE_MAGIC_LEN + 1;
+}
+
+int trace_next(const uint8_t* buf, size_t len, size_t* off, t_trace_record* rec)
+{
+    if (*off >= len)
+        return 0;
+
+    size_t pos = *off;
+    size_t n;
+    memset(rec, 0, sizeof(*rec));
+    rec->op = buf[pos++];
+
+    if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->delta_ns)))
+        return -1;
+    pos += n;
+
+    switch (rec->op)
+    {
+    case TRACE_MALLOC:
+    case TRACE_CALLOC:
+        if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->size)))
+            return -1;
+        pos += n;
+        if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->id_out)))
+            return -1;
+        pos += n;
+        break;
+    case TRACE_FREE:
+        if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->id_in)))
+            return -1;
+        pos += n;
+        break;
+    case TRACE_REALLOC:
+        if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->id_in)))
+            return -1;
+        pos += n;
+        if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->size)))
+            return -1;
+        pos += n;
+        if (!(n = trace_decode_varint(buf + pos, len - pos, &rec->id_out)))
+            return -1;
+        pos += n;
+        break;
+    default:
+        return -1;
+    }
+
+    *off = pos;
+    return 1;
+}
+
+/**
+ * @struct s_replay
+ * @brief Estado del replay: direccion vigente de cada id del trace.
+ */
+struct s_replay
+{
+    void** ptrs; /**< Direccion por id (mapeada fuera del heap medido) */
+    size_t cap;  /**< Cantidad de ids que entran en ptrs */
+};
+
+static int replay_ensure(struct s_replay* r, uint64_t id)
+{
+    if (id < r->cap)
+        return 0;
+
+    size_t cap = r->cap;
+    while (cap <= id)
+        cap *= 2;
+
+    void* p = mremap(r->ptrs, r->cap * sizeof(void*), cap * sizeof(void*), MREMAP_MAYMOVE);
+    if (p == MAP_FAILED)
+        return -1;
+    r->ptrs = p;
+    r->cap = cap;
+    return 0;
+}
+
+static void* replay_take(struct s_replay* r, uint64_t id)
+{
+    if (id == 0 || id >= r->cap)
+        return NULL;
+    void* p = r->ptrs[id];
+    r->ptrs[id] = NULL;
+    return p;
+}
+
+static int replay_store(struct s_replay* r, uint64_t id, void* p, size_t size, t_trace_replay* result)
+{
+    if (!p)
+    {
+        result->failed += size > 0;
+        return 0;
+    }
+    if (id == 0)
+        return 0;
+    if (replay_ensure(r, id) != 0)
+        return -1;
+    r->ptrs[id] = p;
+    return 0;
+}
+
+static int replay_run(struct s_replay* r, const uint8_t* buf, size_t len, size_t off, t_trace_replay* result)
+{
+    t_trace_record rec;
+    int st;
+
+    while ((st = trace_next(buf, len, &off, &rec)) == 1)
+    {
+        size_t size = (size_t)rec.size;
+        void* p;
+
+        switch (rec.op)
+        {
+        case TRACE_MALLOC:
+            p = malloc(size);
+            // Se escribe el bloque para que el RSS refleje el uso real
+            if (p)
+                memset(p, 0xA5, size);
+            break;
+        case TRACE_CALLOC:
+            p = calloc(1, size);
+            break;
+        case TRACE_FREE:
+            free(replay_take(r, rec.id_in));
+            p = NULL;
+            break;
+        case TRACE_REALLOC:
+            p = realloc(replay_take(r, rec.id_in), size);
+            break;
+        default:
+            return -1;
+        }
+
+        if (rec.op != TRACE_FREE && replay_store(r, rec.id_out, p, size, result) != 0)
+            return -1;
+        result->ops++;
+    }
+    return st;
+}
+
+int trace_replay(const uint8_t* buf, size_t len, t_trace_replay* result)
+{
+    memset(result, 0, sizeof(*result));
+    size_t off = trace_check_header(buf, len);
+    if (off == 0)
+        return -1;
+
+    struct s_replay r;
+    r.cap = REPLAY_IDS_INITIAL;
+    r.ptrs = mmap(NULL, r.cap * sizeof(void*), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (r.ptrs == MAP_FAILED)
+        return -1;
+
+    // Solo se mide la politica: sin el log (una pagina por operacion) y sin
+    // capturar el propio replay si hay un trace abierto. El estado del trace no
+    // se toca: otro hilo puede estar capturando con el lock del heap
+    int log = set_log_enabled(0);
+    trace_replaying = 1;
+
+    uint64_t start = now_ns();
+    int st = replay_run(&r, buf, len, off, result);
+    result->elapsed_ns = now_ns() - start;
+
+    trace_replaying = 0;
+    set_log_enabled(log);
+    munmap(r.ptrs, r.cap * sizeof(void*));
+    return st < 0 ? -1 : 0;
+}
+
+// Permite capturar un proceso sin recompilarlo: MEMORY_TRACE_FILE=/ruta/al/trace
+__attribute__((constructor)) static void trace_from_env(void)
+{
+    const char* path = getenv(TRACE_ENV);
+    if (path && *path)
+        trace_open(path);
+}
+
+__attribute__((destructor)) static void trace_at_exit(void)
+{
+    trace_close();
+}
@@ -1,11 +1,23 @@
 #include "memory.h"
+#include "profile.h"
+#include "slab.h"
+#include "trace.h"
 #include "unity.h"
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <signal.h>
 #include <string.h>
+#include <sys/wait.h>
 #include <time.h>
+#include <unistd.h>
 
 #define NUM_ALLOCS 200
 #define MAX_SIZE 256
+// Operaciones de malloc del trace del test de replay (cada una con su free)
+#define REPLAY_TEST_OPS 20000
+// Margen de RSS del replay sobre lo mapeado por el heap
+#define REPLAY_TEST_SLACK (4 * 1024 * 1024)
 
 // Se corre antes de cada test
 void setUp(void)
@@ -15,6 +27,8 @@ void setUp(void)
     registro_calloc = 0;
     registro_realloc = 0;
     free_logs();
+    // Los tests de bloques miran cabeceras: los que usan slabs los activan
+    set_slab_enabled(0);
 }
 
 // Se corre después de cada test
@@ -57,6 +71,44 @@ void test_calloc(void)
     TEST_ASSERT_EQUAL(1, registro_free);
 }
 
+// calloc no toca las paginas de un mapeo nuevo, limpia lo reutilizado y
+// rechaza tamanos que desbordan
+void test_calloc_lazy_zero(void)
+{
+    size_t len = 64 * MMAP_THRESHOLD;
+    unsigned char* big = calloc(len, 1);
+    TEST_ASSERT_NOT_NULL(big);
+
+    // Ninguna pagina del mapeo deberia estar residente todavia
+    char* first = (char*)((uintptr_t)big & ~(uintptr_t)(PAGESIZE - 1)) + PAGESIZE;
+    size_t pages = (len - 2 * PAGESIZE) / PAGESIZE;
+    unsigned char* vec = mmap(NULL, pages, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_ASSERT_TRUE(vec != MAP_FAILED);
+    TEST_ASSERT_EQUAL(0, mincore(first, pages * PAGESIZE, vec));
+    size_t resident = 0;
+    for (size_t i = 0; i < pages; i++)
+        resident += vec[i] & 1;
+    TEST_ASSERT_EQUAL(0, resident);
+    munmap(vec, pages);
+    TEST_ASSERT_EQUAL(0, big[len / 2]);
+    free(big);
+
+    // Un bloque reutilizado se limpia completo
+    unsigned char* dirty = malloc(1000);
+    memset(dirty, 0xFF, 1000);
+    free(dirty);
+    unsigned char* clean = calloc(250, 4);
+    for (int i = 0; i < 1000; i++)
+        TEST_ASSERT_EQUAL(0, clean[i]);
+    free(clean);
+
+    volatile size_t huge = (size_t)-1 / 2;
+    errno = 0;
+    TEST_ASSERT_NULL(calloc(huge, 4));
+    TEST_ASSERT_EQUAL(ENOMEM, errno);
+    TEST_ASSERT_EQUAL(3, registro_calloc);
+}
+
 // Test 3: realloc expandiendo
 void test_realloc_expand(void)
 {
@@ -64,19 +116,62 @@ void test_realloc_expand(void)
     for (int i = 0; i < 10; i++)
         arr[i] = i;
 
-    arr = realloc(arr, 20 * sizeof(int));
-    TEST_ASSERT_NOT_NULL(arr);
+    int* grown = realloc(arr, 20 * sizeof(int));
+    TEST_ASSERT_NOT_NULL(grown);
+    TEST_ASSERT_EQUAL_PTR(arr, grown); // crece sobre la cola libre de la arena
 
     for (int i = 0; i < 10; i++)
     {
-        TEST_ASSERT_EQUAL(i, arr[i]);
+        TEST_ASSERT_EQUAL(i, grown[i]);
     }
 
-    free(arr);
+    free(grown);
 
-    TEST_ASSERT_EQUAL(2, registro_malloc);  // malloc inicial + malloc interno
+    TEST_ASSERT_EQUAL(1, registro_malloc);  // sin malloc interno
     TEST_ASSERT_EQUAL(1, registro_realloc); // una llamada a realloc
-    TEST_ASSERT_EQUAL(2, registro_free);    // free interno + free final
+    TEST_ASSERT_EQUAL(1, registro_free);    // solo el free final
+}
+
+// Test 3b: realloc achicando libera el sobrante
+void test_realloc_shrink(void)
+{
+    char* p = malloc(1024);
+    char* guard = malloc(64); // evita que el sobrante se fusione con la cola
+    memset(p, 0x5A, 1024);
+
+    char* q = realloc(p, 100);
+    TEST_ASSERT_EQUAL_PTR(p, q);
+    TEST_ASSERT_EACH_EQUAL_HEX8(0x5A, q, 100);
+
+    t_block b = get_block(q);
+    TEST_ASSERT_EQUAL(align(100), block_size(b));
+    TEST_ASSERT_TRUE(block_is_free(next_block(b)));
+
+    // El hueco liberado se reutiliza
+    void* r = malloc(512);
+    TEST_ASSERT_EQUAL_PTR(next_block(b)->data, r);
+
+    free(r);
+    free(guard);
+    free(q);
+}
+
+// Test 3c: realloc de un bloque grande usa mremap
+void test_realloc_mapped(void)
+{
+    size_t big = MMAP_THRESHOLD * 2;
+    char* p = malloc(big);
+    TEST_ASSERT_NOT_NULL(p);
+    TEST_ASSERT_TRUE(block_is_mapped(get_block(p)));
+    memset(p, 0x3C, big);
+
+    char* q = realloc(p, big * 4);
+    TEST_ASSERT_NOT_NULL(q);
+    TEST_ASSERT_TRUE(block_is_mapped(get_block(q)));
+    TEST_ASSERT_EACH_EQUAL_HEX8(0x3C, q, big);
+    TEST_ASSERT_EQUAL(1, registro_malloc); // sin malloc + memcpy
+
+    free(q);
 }
 
 // Test 4: fusión de bloques libres
@@ -167,42 +262,750 @@ void run_policy_test(int policy, const char* name)
     double ms = (double)(end - start) / 1e6;
 
     // medir fragmentación
-    size_t free_mem = 0, used_mem = 0, max_free_block = 0;
-    t_block b = base;
-    while (b)
+    t_mem_stats st;
+    memory_stats(&st);
+
+    printf("=== %s ===\n", name);
+    printf("Tiempo total: %.2f ms\n", ms);
+    printf("Memoria usada: %zu bytes, libre: %zu bytes\n", st.used_bytes, st.free_bytes);
+    printf("Fragmentación externa: %.2f%%\n\n", st.fragmentation * 100.0);
+}
+
+// Test 8: policies comparison
+void test_policy_efficiency(void)
+{
+    srand((unsigned int)time(NULL));
+    run_policy_test(FIRST_FIT, "First Fit");
+    run_policy_test(BEST_FIT, "Best Fit");
+    run_policy_test(WORST_FIT, "Worst Fit");
+}
+
+// Test 8b: etiquetas de frontera
+void test_boundary_tags(void)
+{
+    TEST_ASSERT_LESS_OR_EQUAL(16, sizeof(struct s_block));
+
+    char* a = malloc(64);
+    char* b = malloc(64);
+    char* c = malloc(64);
+    char* guard = malloc(64);
+    TEST_ASSERT_EQUAL_PTR(get_block(b), next_block(get_block(a)));
+    TEST_ASSERT_EQUAL_PTR(get_block(c), next_block(get_block(b)));
+
+    // El orden de liberacion no importa: b se une con ambos vecinos en O(1)
+    t_block merged = get_block(a);
+    free(a);
+    free(c);
+    free(b);
+
+    TEST_ASSERT_TRUE(block_is_free(merged));
+    TEST_ASSERT_EQUAL(3 * 64 + 2 * BLOCK_SIZE, block_size(merged));
+    TEST_ASSERT_EQUAL_PTR(get_block(guard), next_block(merged));
+    TEST_ASSERT_TRUE(prev_is_free(get_block(guard)));
+
+    free(guard);
+}
+
+// Best Fit elige el menor bloque que alcanza (aunque sobren mas de 4 KiB),
+// Worst Fit el mayor y First Fit el de menor direccion, sin recorrer la lista
+// de libres
+void test_fit_policies(void)
+{
+    size_t sizes[4] = {1024, 6000, 20000, 3000};
+    char* blocks[4];
+    char* guards[4];
+    for (int i = 0; i < 4; i++)
     {
-        if (b->free)
+        blocks[i] = malloc(sizes[i]);
+        guards[i] = malloc(64);
+    }
+    for (int i = 0; i < 4; i++)
+        free(blocks[i]);
+
+    malloc_control(BEST_FIT);
+    char* p = malloc(4000); // el de 6000: el de 20000 sobra por mas de una pagina
+    TEST_ASSERT_EQUAL_PTR(blocks[1], p);
+    char* q = malloc(20000); // iguala exacto al de 20000
+    TEST_ASSERT_EQUAL_PTR(blocks[2], q);
+    free(p);
+    free(q);
+
+    malloc_control(WORST_FIT);
+    t_mem_stats st;
+    memory_stats(&st);
+    char* w = malloc(100);
+    t_block wb = get_block(w);
+    TEST_ASSERT_EQUAL(st.largest_free, block_size(wb) + BLOCK_SIZE + block_size(next_block(wb)));
+    free(w);
+
+    // El ultimo liberado fue el de 3000, pero el primero por direccion que
+    // alcanza es el de 6000
+    malloc_control(FIRST_FIT);
+    char* f = malloc(2000);
+    TEST_ASSERT_EQUAL_PTR(blocks[1], f);
+    char* g = malloc(500);
+    TEST_ASSERT_EQUAL_PTR(blocks[0], g);
+    free(f);
+    free(g);
+    for (int i = 0; i < 4; i++)
+        free(guards[i]);
+}
+
+// Recorre el heap verificando etiquetas, que no queden libres adyacentes y que
+// las estadisticas incrementales coincidan con el recorrido completo
+static void assert_heap_consistent(void)
+{
+    size_t used = 0, freem = 0, largest = 0, mapped = 0;
+    for (t_arena a = arenas; a; a = a->next)
+    {
+        mapped += a->size;
+        for (t_block b = arena_first(a); !is_epilogue(b); b = next_block(b))
         {
-            free_mem += b->size;
-            if (b->size > max_free_block)
-                max_free_block = b->size;
+            t_block n = next_block(b);
+            TEST_ASSERT_TRUE(n->prev_foot == b->head);
+            TEST_ASSERT_FALSE(block_is_free(b) && block_is_free(n));
+            if (block_is_free(b))
+            {
+                freem += block_size(b);
+                largest = block_size(b) > largest ? block_size(b) : largest;
+            }
+            else
+            {
+                used += block_size(b);
+            }
         }
+    }
+
+    t_mem_stats st;
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(used + st.slab_used_bytes, st.used_bytes);
+    TEST_ASSERT_EQUAL(freem, st.free_bytes);
+    TEST_ASSERT_EQUAL(largest, st.largest_free);
+    TEST_ASSERT_EQUAL(mapped, st.mapped_bytes);
+    TEST_ASSERT_EQUAL(0, check_heap_all());
+}
+
+// Test 8c: operaciones aleatorias mantienen el heap consistente
+void test_heap_consistency(void)
+{
+    void* ptrs[NUM_ALLOCS] = {0};
+    set_slab_enabled(1);
+
+    for (int i = 0; i < NUM_ALLOCS * 10; i++)
+    {
+        int k = rand() % NUM_ALLOCS;
+        size_t size = (size_t)(rand() % (MAX_SIZE * 4)) + 1;
+        if (!ptrs[k])
+            ptrs[k] = malloc(size);
+        else if (i % 2)
+            ptrs[k] = realloc(ptrs[k], size);
         else
         {
-            used_mem += b->size;
+            free(ptrs[k]);
+            ptrs[k] = NULL;
         }
-        b = b->next;
+        if (ptrs[k])
+            memset(ptrs[k], 0x11, size);
     }
+    assert_heap_consistent();
+
+    for (int i = 0; i < NUM_ALLOCS; i++)
+        free(ptrs[i]);
+    assert_heap_consistent();
+}
+
+// Test 8d: exportacion de estadisticas
+void test_stats_export(void)
+{
+    void* p = malloc(100);
+    void* q = malloc(MMAP_THRESHOLD);
 
-    double frag_ext = 0.0;
-    if (max_free_block > 0 && free_mem > 0)
+    t_mem_stats st;
+    memory_stats(&st);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, st.arena_count);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, st.mapped_blocks);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, st.used_by_class[2]); // 112 bytes: clase [64, 128)
+
+    char buf[8192];
+    int n = memory_stats_json(buf, sizeof(buf));
+    TEST_ASSERT_LESS_THAN((int)sizeof(buf), n);
+    TEST_ASSERT_EQUAL('{', buf[0]);
+    TEST_ASSERT_EQUAL('}', buf[n - 1]);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"fragmentation\":"));
+
+    n = memory_stats_prometheus(buf, sizeof(buf));
+    TEST_ASSERT_LESS_THAN((int)sizeof(buf), n);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "# TYPE allocator_used_bytes gauge\n"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "allocator_blocks{state=\"free\",class=\"16\"}"));
+
+    // Un buffer chico se trunca sin pasarse
+    char small[16];
+    TEST_ASSERT_GREATER_THAN(15, memory_stats_json(small, sizeof(small)));
+    TEST_ASSERT_EQUAL(15, strlen(small));
+
+    free(q);
+    free(p);
+}
+
+// Los pedidos chicos salen de slabs sin cabecera por objeto
+void test_slab(void)
+{
+    static char* objs[2 * SLAB_SIZE / 32];
+    int n = (int)(sizeof(objs) / sizeof(objs[0]));
+    set_slab_enabled(1);
+
+    t_mem_stats before, st;
+    memory_stats(&before);
+    for (int i = 0; i < n; i++)
     {
-        frag_ext = (double)(free_mem - max_free_block) / (double)free_mem;
+        objs[i] = malloc(24); // clase de 32 bytes
+        TEST_ASSERT_TRUE(slab_owns(objs[i]));
+        memset(objs[i], i & 0xFF, 24);
     }
+    // Objetos contiguos, sin cabecera entre ellos (salvo al cambiar de slab)
+    int contiguous = 0;
+    for (int i = 1; i < n; i++)
+        contiguous += objs[i] - objs[i - 1] == 32;
+    TEST_ASSERT_GREATER_THAN(n / 2, contiguous);
+    TEST_ASSERT_EQUAL(32, slab_usable_size(objs[0]));
 
-    printf("=== %s ===\n", name);
-    printf("Tiempo total: %.2f ms\n", ms);
-    printf("Memoria usada: %zu bytes, libre: %zu bytes\n", used_mem, free_mem);
-    printf("Fragmentación externa: %.2f%%\n\n", frag_ext * 100.0);
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(before.slab_used_bytes + (size_t)n * 32, st.slab_used_bytes);
+    TEST_ASSERT_GREATER_OR_EQUAL(2 * SLAB_SIZE, st.slab_bytes);
+
+    // realloc dentro de la clase no mueve; si no entra, copia y libera
+    TEST_ASSERT_EQUAL_PTR(objs[0], realloc(objs[0], 30));
+    char* moved = realloc(objs[0], 400);
+    TEST_ASSERT_FALSE(moved == objs[0]);
+    TEST_ASSERT_EACH_EQUAL_HEX8(0, moved, 24);
+    objs[0] = moved;
+
+    // Un puntero interior o un doble free se ignoran
+    volatile uintptr_t inner = (uintptr_t)objs[1] + 8;
+    free((void*)inner);
+    free(objs[2]);
+    free(objs[2]);
+    objs[2] = NULL;
+
+    char* z = calloc(3, 8);
+    for (int i = 0; i < 24; i++)
+        TEST_ASSERT_EQUAL(0, z[i]);
+    free(z);
+
+    for (int i = 0; i < n; i++)
+        free(objs[i]);
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(before.slab_used_bytes, st.slab_used_bytes);
+    TEST_ASSERT_EQUAL(before.used_bytes, st.used_bytes);
+    malloc_trim(0);
 }
 
-// Test 8: policies comparison
-void test_policy_efficiency(void)
+// free() desmapea las arenas vacias (salvo una) y malloc_trim() devuelve el resto
+void test_trim(void)
 {
-    srand((unsigned int)time(NULL));
-    run_policy_test(FIRST_FIT, "First Fit");
-    run_policy_test(BEST_FIT, "Best Fit");
-    run_policy_test(WORST_FIT, "Worst Fit");
+    static void* ptrs[4 * ARENA_SIZE / 1024];
+    int n = (int)(sizeof(ptrs) / sizeof(ptrs[0]));
+    t_mem_stats before, st;
+    memory_stats(&before);
+
+    for (int i = 0; i < n; i++)
+    {
+        ptrs[i] = malloc(1000);
+        memset(ptrs[i], 0x5A, 1000);
+    }
+    memory_stats(&st);
+    TEST_ASSERT_GREATER_OR_EQUAL(before.arena_count + 3, st.arena_count);
+
+    for (int i = 0; i < n; i++)
+        free(ptrs[i]);
+    memory_stats(&st);
+    TEST_ASSERT_LESS_OR_EQUAL(before.arena_count + 1, st.arena_count);
+    assert_heap_consistent();
+
+    // Con free() sin devolver nada, malloc_trim libera la arena de repuesto
+    set_trim_threshold((size_t)-1);
+    void* p = malloc(100000);
+    memset(p, 0x5A, 100000);
+    free(p);
+    memory_stats(&before);
+    TEST_ASSERT_EQUAL(1, malloc_trim(0));
+    memory_stats(&st);
+    TEST_ASSERT_TRUE(st.mapped_bytes < before.mapped_bytes || st.released_bytes > before.released_bytes);
+    assert_heap_consistent();
+    set_trim_threshold(TRIM_THRESHOLD);
+
+    // Lo devuelto vuelve a valer cero y el heap sigue usable
+    unsigned char* z = calloc(1, 100000);
+    for (int i = 0; i < 100000; i += 997)
+        TEST_ASSERT_EQUAL(0, z[i]);
+    free(z);
+}
+
+// Cada nodo NUMA tiene su heap: lo que libera un hilo de otro nodo vuelve al
+// heap de la arena del bloque
+void test_numa_arenas(void)
+{
+    t_mem_stats before, st;
+    memory_stats(&before);
+    TEST_ASSERT_GREATER_OR_EQUAL(1, before.numa_nodes);
+
+    set_numa_node(1);
+    void* p = malloc(1000);
+    void* keep = malloc(1000);
+    void* big = malloc(MMAP_THRESHOLD);
+    TEST_ASSERT_EQUAL(1, arena_of(get_block(p))->node);
+    TEST_ASSERT_EQUAL(1, ((t_arena)((char*)get_block(big) - ARENA_HEADER))->node);
+
+    set_numa_node(0);
+    free(p);
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(before.remote_frees + 1, st.remote_frees);
+
+    // El hueco del nodo 1 no se usa para un pedido del nodo 0, si para uno del nodo 1
+    void* q = malloc(1000);
+    TEST_ASSERT_EQUAL(0, arena_of(get_block(q))->node);
+    set_numa_node(1);
+    void* r = malloc(1000);
+    TEST_ASSERT_TRUE(arena_of(get_block(r)) == arena_of(get_block(keep)));
+
+    free(r);
+    free(keep);
+    free(big);
+    set_numa_node(0);
+    free(q);
+    set_numa_node(-1);
+    assert_heap_consistent();
+}
+
+// Con paginas grandes las arenas salen de chunks de HUGE_PAGE_SIZE y las
+// vacias vuelven a un pool hasta que malloc_trim libera los chunks enteros
+void test_huge_pages(void)
+{
+    static void* ptrs[3 * ARENA_SIZE / 1024];
+    int n = (int)(sizeof(ptrs) / sizeof(ptrs[0]));
+    t_mem_stats st;
+
+    set_huge_pages(1);
+    for (int i = 0; i < n; i++)
+    {
+        ptrs[i] = malloc(1000);
+        memset(ptrs[i], 0x5A, 1000);
+    }
+    memory_stats(&st);
+    TEST_ASSERT_GREATER_THAN(0, st.huge_pool_bytes);
+    TEST_ASSERT_EQUAL(0, st.huge_pool_bytes % ARENA_SIZE);
+    TEST_ASSERT_TRUE(st.hugetlb_bytes <= st.huge_bytes);
+    TEST_ASSERT_NOT_EQUAL(0, arena_of(get_block(ptrs[n - 1]))->chunk);
+    assert_heap_consistent();
+
+    // Las arenas reutilizadas ya fueron escritas: calloc las tiene que limpiar
+    for (int i = 0; i < n; i++)
+        free(ptrs[i]);
+    unsigned char* z = calloc(1, 100000);
+    unsigned char* y = calloc(1, 100000);
+    for (int i = 0; i < 100000; i += 997)
+        TEST_ASSERT_EQUAL(0, z[i] | y[i]);
+    free(z);
+    free(y);
+
+    set_huge_pages(0);
+    malloc_trim(0);
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(0, st.huge_pool_bytes);
+    TEST_ASSERT_EQUAL(0, st.huge_bytes);
+    assert_heap_consistent();
+}
+
+// Manejador de errores del heap que solo cuenta, para no abortar los tests
+static int heap_errors = 0;
+static void* heap_error_ptr = NULL;
+
+static void record_heap_error(const char* error, void* ptr)
+{
+    (void)error;
+    heap_errors++;
+    heap_error_ptr = ptr;
+}
+
+// check_heap_all detecta una cabecera pisada
+void test_check_heap_all(void)
+{
+    char* p = malloc(100);
+    char* q = malloc(100);
+    TEST_ASSERT_EQUAL(0, check_heap_all());
+
+    set_debug_handler(record_heap_error);
+    heap_errors = 0;
+    t_block b = get_block(q);
+    size_t head = b->head;
+    b->head = head + 64;
+    TEST_ASSERT_GREATER_THAN(0, check_heap_all());
+    TEST_ASSERT_GREATER_THAN(0, heap_errors);
+
+    b->head = head;
+    heap_errors = 0;
+    TEST_ASSERT_EQUAL(0, check_heap_all());
+    TEST_ASSERT_EQUAL(0, heap_errors);
+    set_debug_handler(NULL);
+    free(p);
+    free(q);
+}
+
+// Canarios, doble free, cuarentena y pagina de guarda
+void test_debug_mode(void)
+{
+#ifdef MEMORY_DEBUG
+    set_debug_handler(record_heap_error);
+    heap_errors = 0;
+    TEST_ASSERT_EQUAL(0, set_debug_flags(DEBUG_CANARY));
+
+    // Desborde de un byte: lo ven el recorrido y free
+    char* p = malloc(100);
+    TEST_ASSERT_EQUAL(100, malloc_usable_size(p));
+    p[100] = 'x';
+    TEST_ASSERT_EQUAL(1, check_heap_all());
+    free(p);
+    TEST_ASSERT_EQUAL(2, heap_errors);
+    TEST_ASSERT_EQUAL_PTR(p, heap_error_ptr);
+
+    // Doble free sin cuarentena: el bloque ya esta libre
+    free(p);
+    TEST_ASSERT_EQUAL(3, heap_errors);
+
+    // Con cuarentena el bloque sigue marcado y realloc siempre mueve
+    TEST_ASSERT_EQUAL(0, set_debug_flags(DEBUG_QUARANTINE));
+    heap_errors = 0;
+    char* r = malloc(10);
+    memcpy(r, "cuarentena", 10);
+    char* moved = realloc(r, 1000);
+    TEST_ASSERT_NOT_EQUAL(r, moved);
+    TEST_ASSERT_EQUAL_MEMORY("cuarentena", moved, 10);
+    free(moved);
+    free(moved);
+    TEST_ASSERT_EQUAL(1, heap_errors);
+    TEST_ASSERT_EQUAL_PTR(moved, heap_error_ptr);
+
+    // Escritura despues de free: la ve el recorrido y la salida de la cuarentena
+    heap_errors = 0;
+    char* q = malloc(64);
+    free(q);
+    q[10] = 'x';
+    TEST_ASSERT_EQUAL(1, check_heap_all());
+    TEST_ASSERT_EQUAL(0, set_debug_flags(DEBUG_CANARY));
+    TEST_ASSERT_EQUAL(2, heap_errors);
+    TEST_ASSERT_EQUAL_PTR(q, heap_error_ptr);
+
+    // La pagina siguiente al epilogo de un mapeo propio no tiene permisos
+    TEST_ASSERT_EQUAL(0, set_debug_flags(DEBUG_GUARD));
+    char* big = malloc(MMAP_THRESHOLD);
+    char* guard = big + block_size(get_block(big)) + BLOCK_SIZE;
+    TEST_ASSERT_EQUAL(0, (uintptr_t)guard & (PAGESIZE - 1));
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        guard[0] = 1;
+        _exit(0);
+    }
+    int status;
+    TEST_ASSERT_EQUAL(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+    free(big);
+
+    TEST_ASSERT_EQUAL(2, heap_errors);
+    TEST_ASSERT_EQUAL(0, set_debug_flags(0));
+    set_debug_handler(NULL);
+    assert_heap_consistent();
+#else
+    // Sin MEMORY_DEBUG los chequeos no existen
+    TEST_ASSERT_EQUAL(-1, set_debug_flags(DEBUG_CANARY));
+    TEST_ASSERT_EQUAL(0, set_debug_flags(0));
+#endif
+}
+
+// Scope: muchos objetos chicos por chunk y liberacion en bloque
+void test_scope(void)
+{
+    t_mem_stats before, st;
+    memory_stats(&before);
+
+    t_scope s = scope_create(4096);
+    TEST_ASSERT_NOT_NULL(s);
+    char* first = scope_alloc(s, 24);
+    char* prev = first;
+    for (int i = 0; i < 1000; i++)
+    {
+        char* p = scope_alloc(s, (size_t)(i % 100) + 1);
+        TEST_ASSERT_NOT_NULL(p);
+        TEST_ASSERT_EQUAL(0, (uintptr_t)p & (MALLOC_ALIGN - 1));
+        TEST_ASSERT_TRUE(p != prev);
+        memset(p, 0x3C, (size_t)(i % 100) + 1);
+        prev = p;
+    }
+    // ~60 KB en chunks de 4 KB: un bloque del heap por chunk, no por objeto
+    memory_stats(&st);
+    TEST_ASSERT_LESS_THAN(before.used_blocks + 32, st.used_blocks);
+
+    // Un pedido grande va a un chunk propio y no corta el chunk actual
+    char* next = scope_alloc(s, 16);
+    TEST_ASSERT_NOT_NULL(scope_alloc(s, 3000));
+    TEST_ASSERT_EQUAL_PTR(next + 16, scope_alloc(s, 16));
+
+    // El reset conserva el primer chunk
+    scope_reset(s);
+    TEST_ASSERT_EQUAL_PTR(first, scope_alloc(s, 24));
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(before.used_blocks + 1, st.used_blocks);
+
+    scope_destroy(s);
+    memory_stats(&st);
+    TEST_ASSERT_EQUAL(before.used_bytes, st.used_bytes);
+    assert_heap_consistent();
+}
+
+// posix_memalign, aligned_alloc, valloc y malloc_usable_size
+void test_aligned_alloc(void)
+{
+    size_t aligns[] = {32, 64, PAGESIZE, (size_t)1 << 20};
+    size_t sizes[] = {1, 100, 5000, MMAP_THRESHOLD};
+
+    for (size_t i = 0; i < sizeof(aligns) / sizeof(aligns[0]); i++)
+    {
+        for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++)
+        {
+            void* p = NULL;
+            TEST_ASSERT_EQUAL(0, posix_memalign(&p, aligns[i], sizes[j]));
+            TEST_ASSERT_EQUAL(0, (uintptr_t)p & (aligns[i] - 1));
+            TEST_ASSERT_GREATER_OR_EQUAL(sizes[j], malloc_usable_size(p));
+            memset(p, 0x6B, sizes[j]);
+            assert_heap_consistent();
+
+            // realloc conserva el contenido aunque pierda la alineacion
+            unsigned char* q = realloc(p, sizes[j] * 2);
+            TEST_ASSERT_NOT_NULL(q);
+            TEST_ASSERT_EQUAL(0x6B, q[sizes[j] - 1]);
+            free(q);
+        }
+    }
+
+    void* p = (void*)1;
+    TEST_ASSERT_EQUAL(EINVAL, posix_memalign(&p, 24, 100));
+    TEST_ASSERT_EQUAL(EINVAL, posix_memalign(&p, 4, 100));
+    TEST_ASSERT_EQUAL_PTR((void*)1, p);
+    errno = 0;
+    TEST_ASSERT_NULL(aligned_alloc(48, 100));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+
+    void* v = valloc(10);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)v & (PAGESIZE - 1));
+    void* m = malloc(24);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)m & (MALLOC_ALIGN - 1));
+    TEST_ASSERT_GREATER_OR_EQUAL(24, malloc_usable_size(m));
+    TEST_ASSERT_EQUAL(0, malloc_usable_size(NULL));
+    free(v);
+    free(m);
+    assert_heap_consistent();
+}
+
+// Test 9: varints del trace
+void test_trace_varint(void)
+{
+    uint64_t values[] = {0, 1, 127, 128, 300, 1ULL << 35, UINT64_MAX};
+    uint8_t buf[TRACE_VARINT_MAX];
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        uint64_t out = 0;
+        size_t n = trace_encode_varint(buf, values[i]);
+        TEST_ASSERT_EQUAL(n, trace_decode_varint(buf, n, &out));
+        TEST_ASSERT_TRUE(out == values[i]);
+        // Un varint truncado no se decodifica
+        TEST_ASSERT_EQUAL(0, trace_decode_varint(buf, n - 1, &out));
+    }
+}
+
+// Test 10: captura y lectura de un trace
+void test_trace_roundtrip(void)
+{
+    const char* path = "test_trace.bin";
+    TEST_ASSERT_EQUAL(0, trace_open(path));
+
+    void* a = malloc(100);
+    void* b = calloc(4, 8);
+    a = realloc(a, 300);
+    free(b);
+    free(a);
+    trace_close();
+
+    uint8_t buf[256];
+    FILE* f = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(f);
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    remove(path);
+
+    size_t off = trace_check_header(buf, len);
+    TEST_ASSERT_GREATER_THAN(0, off);
+
+    // Las llamadas internas de calloc/realloc no se registran
+    uint8_t ops[] = {TRACE_MALLOC, TRACE_CALLOC, TRACE_REALLOC, TRACE_FREE, TRACE_FREE};
+    t_trace_record rec[5];
+    for (int i = 0; i < 5; i++)
+    {
+        TEST_ASSERT_EQUAL(1, trace_next(buf, len, &off, &rec[i]));
+        TEST_ASSERT_EQUAL(ops[i], rec[i].op);
+    }
+    TEST_ASSERT_EQUAL(0, trace_next(buf, len, &off, &rec[0]));
+
+    TEST_ASSERT_EQUAL(100, rec[0].size);
+    TEST_ASSERT_EQUAL(32, rec[1].size);
+    TEST_ASSERT_TRUE(rec[2].id_in == rec[0].id_out);
+    TEST_ASSERT_EQUAL(300, rec[2].size);
+    TEST_ASSERT_TRUE(rec[3].id_in == rec[1].id_out);
+    TEST_ASSERT_TRUE(rec[4].id_in == rec[2].id_out);
+}
+
+// Cuenta los registros de un archivo de trace; -1 si no se puede decodificar entero
+static int count_trace_records(const char* path)
+{
+    static uint8_t buf[4096];
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return -1;
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+
+    size_t off = trace_check_header(buf, len);
+    if (off == 0)
+        return -1;
+    t_trace_record rec;
+    int n = 0;
+    int st;
+    while ((st = trace_next(buf, len, &off, &rec)) == 1)
+        n++;
+    return st == 0 ? n : -1;
+}
+
+// Test 10c: el hijo de un fork no duplica ni intercala registros en el trace del padre
+void test_trace_fork(void)
+{
+    const char* path = "test_trace_fork.bin";
+    TEST_ASSERT_EQUAL(0, trace_open(path));
+
+    // Quedan en el buffer al momento del fork
+    void* a = malloc(100);
+    free(a);
+
+    pid_t pid = fork();
+    TEST_ASSERT_NOT_EQUAL(-1, pid);
+    if (pid == 0)
+    {
+        void* b = malloc(200);
+        free(b);
+        trace_close();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    void* c = malloc(300);
+    free(c);
+    trace_close();
+
+    char child_path[64];
+    snprintf(child_path, sizeof(child_path), "%s.%d", path, (int)pid);
+    TEST_ASSERT_EQUAL(4, count_trace_records(path));
+    TEST_ASSERT_EQUAL(2, count_trace_records(child_path));
+    remove(path);
+    remove(child_path);
+}
+
+// Paginas residentes del proceso (segundo campo de /proc/self/statm)
+static long resident_bytes(void)
+{
+    long size = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return -1;
+    if (fscanf(f, "%ld %ld", &size, &resident) != 2)
+        resident = -1;
+    fclose(f);
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Test 10b: el replay mide la politica y no el log de operaciones
+void test_trace_replay(void)
+{
+    const char* path = "test_replay.bin";
+    set_log_enabled(0);
+    TEST_ASSERT_EQUAL(0, trace_open(path));
+
+    // Ventana de 64 bloques vivos: el heap nunca necesita mas de ~128 KiB
+    void* live[64] = {0};
+    for (int i = 0; i < REPLAY_TEST_OPS; i++)
+    {
+        int slot = i % 64;
+        free(live[slot]);
+        live[slot] = malloc((size_t)(64 + (i * 37) % 1984));
+    }
+    for (int i = 0; i < 64; i++)
+        free(live[i]);
+    trace_close();
+
+    FILE* f = fopen(path, "rb");
+    TEST_ASSERT_NOT_NULL(f);
+    fseek(f, 0, SEEK_END);
+    size_t len = (size_t)ftell(f);
+    rewind(f);
+    uint8_t* buf = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    TEST_ASSERT_TRUE(buf != MAP_FAILED);
+    TEST_ASSERT_EQUAL(len, fread(buf, 1, len, f));
+    fclose(f);
+    remove(path);
+
+    // Con el log prendido cada operacion dejaria una pagina residente
+    set_log_enabled(1);
+    long before = resident_bytes();
+    t_trace_replay r;
+    TEST_ASSERT_EQUAL(0, trace_replay(buf, len, &r));
+    long after = resident_bytes();
+    TEST_ASSERT_EQUAL(1, set_log_enabled(1));
+
+    // Los primeros 64 free(NULL) tambien quedan en el trace
+    TEST_ASSERT_EQUAL(2 * REPLAY_TEST_OPS + 64, r.ops);
+    TEST_ASSERT_EQUAL(0, r.failed);
+
+    t_mem_stats stats;
+    memory_stats(&stats);
+    TEST_ASSERT_TRUE(after - before <= (long)stats.mapped_bytes + REPLAY_TEST_SLACK);
+    munmap(buf, len);
+}
+
+// Test 11: perfilado muestreado por punto de llamada
+void test_profile(void)
+{
+    TEST_ASSERT_EQUAL(0, profile_set_rate(1000));
+    profile_reset();
+
+    // 40 pedidos de 500 bytes desde el mismo punto: 20 muestras de 1000 bytes
+    void* ptrs[40];
+    for (int i = 0; i < 40; i++)
+        ptrs[i] = malloc(500);
+    profile_set_rate(0);
+    for (int i = 0; i < 40; i++)
+        free(ptrs[i]);
+
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    TEST_ASSERT_EQUAL(1, profile_dump(fds[1]));
+    close(fds[1]);
+    char buf[4096];
+    ssize_t len = read(fds[0], buf, sizeof(buf) - 1);
+    close(fds[0]);
+    TEST_ASSERT_GREATER_THAN(0, len);
+    buf[len] = '\0';
+
+    TEST_ASSERT_NOT_NULL(strstr(buf, "20 samples, 1 sites"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "site 1: 20 samples, 20000 bytes"));
+    profile_reset();
 }
 
 int main(void)
@@ -211,12 +1014,32 @@ int main(void)
 
     RUN_TEST(test_malloc_and_write);
     RUN_TEST(test_calloc);
+    RUN_TEST(test_calloc_lazy_zero);
     RUN_TEST(test_realloc_expand);
+    RUN_TEST(test_realloc_shrink);
+    RUN_TEST(test_realloc_mapped);
     RUN_TEST(test_merge_blocks);
     RUN_TEST(test_logs);
     RUN_TEST(test_memory_usage_stats);
     RUN_TEST(test_check_heap);
     RUN_TEST(test_policy_efficiency);
+    RUN_TEST(test_boundary_tags);
+    RUN_TEST(test_fit_policies);
+    RUN_TEST(test_heap_consistency);
+    RUN_TEST(test_stats_export);
+    RUN_TEST(test_slab);
+    RUN_TEST(test_trim);
+    RUN_TEST(test_aligned_alloc);
+    RUN_TEST(test_numa_arenas);
+    RUN_TEST(test_huge_pages);
+    RUN_TEST(test_check_heap_all);
+    RUN_TEST(test_debug_mode);
+    RUN_TEST(test_scope);
+    RUN_TEST(test_trace_varint);
+    RUN_TEST(test_trace_roundtrip);
+    RUN_TEST(test_trace_replay);
+    RUN_TEST(test_trace_fork);
+    RUN_TEST(test_profile);
 
     return UNITY_END();
 }
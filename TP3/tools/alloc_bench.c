@@ -0,0 +1,593 @@
+/**
+ * @file alloc_bench.c
+ * @brief Benchmark de MemoryLib (First, Best y Worst Fit) contra el malloc de glibc.
+ *
+ * Uso: alloc_bench [operaciones] [hilos] [carga]
+ *
+ * Cada combinacion de carga y allocator corre en un proceso hijo, asi el pico
+ * de RSS es propio de esa corrida. Se imprime una linea CSV por combinacion con
+ * operaciones por segundo, latencias p50/p99 (incluyen el costo de leer el
+ * reloj), pico de RSS, pico de bytes vivos pedidos y la fragmentacion externa
+ * del heap al final de la carga (solo disponible para MemoryLib). En la carga
+ * bandwidth cada pasada sobre un buffer tambien cuenta como operacion, asi que
+ * las operaciones por segundo miden el ancho de banda a la memoria entregada.
+ */
+
+#define _GNU_SOURCE
+
+#include "memory.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/** Operaciones por defecto de cada carga. */
+#define BENCH_OPS 200000
+/** Hilos por defecto de las cargas concurrentes. */
+#define BENCH_THREADS 4
+/** Sub-buckets por potencia de 2 del histograma de latencias. */
+#define HIST_SUB 16
+/** Cantidad de buckets del histograma. */
+#define HIST_BUCKETS (64 * HIST_SUB)
+/** Capacidad de la cola entre productor y consumidor (potencia de 2). */
+#define RING_SIZE 1024
+/** Rondas de la carga tipo larson: al final de cada una se rotan los objetos. */
+#define LARSON_ROUNDS 10
+/** Objetos vivos por hilo en la carga tipo larson. */
+#define LARSON_SLOTS 1000
+/** Buffers por hilo en la carga de ancho de banda. */
+#define BW_BUFFERS 16
+/** Tamano de cada buffer de la carga de ancho de banda (menor a MMAP_THRESHOLD: sale de las arenas). */
+#define BW_SIZE (64 * 1024)
+/** Pasadas de lectura y escritura sobre cada buffer en cada ronda. */
+#define BW_PASSES 8
+
+// Allocator de glibc, accesible aunque MemoryLib reemplace malloc/free/realloc
+extern void* __libc_malloc(size_t size);
+extern void __libc_free(void* ptr);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+/**
+ * @struct s_allocator
+ * @brief Allocator a medir.
+ */
+struct s_allocator
+{
+    const char* name;                   /**< Nombre en el CSV */
+    int policy;                         /**< Politica de MemoryLib, -1 para glibc */
+    void* (*alloc)(size_t);             /**< malloc */
+    void (*release)(void*);             /**< free */
+    void* (*resize)(void*, size_t);     /**< realloc */
+};
+
+static const struct s_allocator allocators[] = {
+    {"tp3-first", FIRST_FIT, malloc, free, realloc},
+    {"tp3-best", BEST_FIT, malloc, free, realloc},
+    {"tp3-worst", WORST_FIT, malloc, free, realloc},
+    {"glibc", -1, __libc_malloc, __libc_free, __libc_realloc},
+};
+
+/**
+ * @struct s_hist
+ * @brief Histograma log-lineal de latencias en nanosegundos (error menor al 7%).
+ */
+struct s_hist
+{
+    uint64_t count[HIST_BUCKETS];
+    uint64_t total;
+};
+
+/**
+ * @struct s_worker
+ * @brief Estado de un hilo de la carga.
+ */
+struct s_worker
+{
+    const struct s_allocator* a;
+    struct s_hist hist;
+    uint64_t rng;
+    size_t ops;
+    int id;
+};
+
+/**
+ * @struct s_result
+ * @brief Resultado de una corrida, compartido entre el hijo y el padre.
+ */
+struct s_result
+{
+    size_t ops;
+    double seconds;
+    uint64_t p50;
+    uint64_t p99;
+    size_t peak_live;
+    double fragmentation;
+    int ok;
+};
+
+/**
+ * @struct s_workload
+ * @brief Carga a medir.
+ */
+struct s_workload
+{
+    const char* name;
+    int threaded;
+    void (*run)(struct s_worker* w, size_t ops, int threads);
+};
+
+static atomic_size_t live_bytes;
+static atomic_size_t peak_live;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t next_rand(uint64_t* s)
+{
+    // xorshift64*
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 0x2545F4914F6CDD1DULL;
+}
+
+static int hist_index(uint64_t ns)
+{
+    if (ns < HIST_SUB)
+        return (int)ns;
+    int e = 63 - __builtin_clzll(ns);
+    return (e - 3) * HIST_SUB + (int)((ns >> (e - 4)) & (HIST_SUB - 1));
+}
+
+static uint64_t hist_value(int i)
+{
+    if (i < HIST_SUB)
+        return (uint64_t)i;
+    int e = i / HIST_SUB + 3;
+    return (uint64_t)(HIST_SUB + i % HIST_SUB) << (e - 4);
+}
+
+static void hist_merge(struct s_hist* dst, const struct s_hist* src)
+{
+    for (int i = 0; i < HIST_BUCKETS; i++)
+        dst->count[i] += src->count[i];
+    dst->total += src->total;
+}
+
+static uint64_t hist_percentile(const struct s_hist* h, double q)
+{
+    uint64_t target = (uint64_t)ceil(q * (double)h->total);
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += h->count[i];
+        if (seen >= target && seen > 0)
+            return hist_value(i);
+    }
+    return 0;
+}
+
+static void live_add(size_t size)
+{
+    size_t now = atomic_fetch_add(&live_bytes, size) + size;
+    size_t peak = atomic_load(&peak_live);
+    while (now > peak && !atomic_compare_exchange_weak(&peak_live, &peak, now))
+        ;
+}
+
+// Operaciones medidas: solo la llamada al allocator entra en la latencia
+static void* bench_alloc(struct s_worker* w, size_t size)
+{
+    uint64_t t0 = now_ns();
+    char* p = w->a->alloc(size);
+    uint64_t dt = now_ns() - t0;
+    w->hist.count[hist_index(dt)]++;
+    w->hist.total++;
+    w->ops++;
+    if (p)
+    {
+        memset(p, 0xA5, size); // el RSS refleja el uso real
+        live_add(size);
+    }
+    return p;
+}
+
+static void bench_free(struct s_worker* w, void* p, size_t size)
+{
+    uint64_t t0 = now_ns();
+    w->a->release(p);
+    uint64_t dt = now_ns() - t0;
+    w->hist.count[hist_index(dt)]++;
+    w->hist.total++;
+    w->ops++;
+    if (p)
+        atomic_fetch_sub(&live_bytes, size);
+}
+
+static void* bench_realloc(struct s_worker* w, void* p, size_t old, size_t size)
+{
+    uint64_t t0 = now_ns();
+    char* q = w->a->resize(p, size);
+    uint64_t dt = now_ns() - t0;
+    w->hist.count[hist_index(dt)]++;
+    w->hist.total++;
+    w->ops++;
+    if (q)
+    {
+        if (size > old)
+            memset(q + old, 0xA5, size - old);
+        live_add(size);
+        atomic_fetch_sub(&live_bytes, old);
+    }
+    return q;
+}
+
+// Los arreglos de trabajo se piden con mmap para no medir al allocator en ellos
+static void* scratch(size_t len)
+{
+    void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        perror("mmap");
+        _exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// Reemplazo aleatorio de objetos vivos en una ventana de slots
+static void churn(struct s_worker* w, void** ptrs, size_t* sizes, size_t slots, size_t ops,
+                  size_t (*pick)(uint64_t*))
+{
+    while (ops > 0)
+    {
+        size_t k = next_rand(&w->rng) % slots;
+        if (ptrs[k])
+        {
+            bench_free(w, ptrs[k], sizes[k]);
+            ptrs[k] = NULL;
+        }
+        else
+        {
+            sizes[k] = pick(&w->rng);
+            ptrs[k] = bench_alloc(w, sizes[k]);
+        }
+        ops--;
+    }
+}
+
+static size_t pick_small(uint64_t* rng)
+{
+    return 16 + next_rand(rng) % 241; // 16 a 256 bytes
+}
+
+static size_t pick_power_law(uint64_t* rng)
+{
+    // P(tamano >= 16 * 2^k) = 2^-k (Pareto con alfa 1), hasta 2 MiB
+    int k = __builtin_ctzll(next_rand(rng) | (1ULL << 16));
+    size_t base = (size_t)16 << k;
+    return base + next_rand(rng) % base;
+}
+
+static size_t pick_medium(uint64_t* rng)
+{
+    return 16 + next_rand(rng) % 1009; // 16 a 1024 bytes
+}
+
+static void run_uniform_small(struct s_worker* w, size_t ops, int threads)
+{
+    (void)threads;
+    size_t slots = 4096;
+    void** ptrs = scratch(slots * sizeof(void*));
+    size_t* sizes = scratch(slots * sizeof(size_t));
+    churn(w, ptrs, sizes, slots, ops, pick_small);
+}
+
+static void run_power_law(struct s_worker* w, size_t ops, int threads)
+{
+    (void)threads;
+    size_t slots = 1024;
+    void** ptrs = scratch(slots * sizeof(void*));
+    size_t* sizes = scratch(slots * sizeof(size_t));
+    churn(w, ptrs, sizes, slots, ops, pick_power_law);
+}
+
+static void run_realloc_growth(struct s_worker* w, size_t ops, int threads)
+{
+    (void)threads;
+    size_t slots = 64;
+    void** ptrs = scratch(slots * sizeof(void*));
+    size_t* sizes = scratch(slots * sizeof(size_t));
+
+    // Buffers que crecen de a poco, como un vector o un string builder
+    for (size_t i = 0; i < ops; i++)
+    {
+        size_t k = next_rand(&w->rng) % slots;
+        size_t grown = sizes[k] + 16 + next_rand(&w->rng) % 1009;
+        if (grown > 256 * 1024)
+        {
+            bench_free(w, ptrs[k], sizes[k]);
+            ptrs[k] = NULL;
+            sizes[k] = 0;
+            continue;
+        }
+        void* q = bench_realloc(w, ptrs[k], sizes[k], grown);
+        if (q)
+        {
+            ptrs[k] = q;
+            sizes[k] = grown;
+        }
+    }
+}
+
+/**
+ * @struct s_ring
+ * @brief Cola de un productor y un consumidor sin locks.
+ */
+struct s_ring
+{
+    _Alignas(64) atomic_size_t head;
+    _Alignas(64) atomic_size_t tail;
+    void* items[RING_SIZE];
+    size_t sizes[RING_SIZE];
+};
+
+/**
+ * @struct s_shared
+ * @brief Estado compartido por los hilos de una carga concurrente.
+ */
+struct s_shared
+{
+    struct s_worker* workers;
+    struct s_ring* rings;
+    void*** slot_sets;
+    size_t** size_sets;
+    pthread_barrier_t barrier;
+    size_t ops;
+    int threads;
+};
+
+static struct s_shared shared;
+
+static void* producer_consumer_thread(void* arg)
+{
+    struct s_worker* w = arg;
+    struct s_ring* r = &shared.rings[w->id / 2];
+    size_t n = shared.ops / (size_t)shared.threads;
+
+    if (w->id % 2 == 0)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+            while (head - atomic_load_explicit(&r->tail, memory_order_acquire) == RING_SIZE)
+                sched_yield();
+            size_t size = pick_small(&w->rng) * 2;
+            r->items[head & (RING_SIZE - 1)] = bench_alloc(w, size);
+            r->sizes[head & (RING_SIZE - 1)] = size;
+            atomic_store_explicit(&r->head, head + 1, memory_order_release);
+        }
+    }
+    else
+    {
+        // Cada objeto se libera en un hilo distinto del que lo pidio
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+            while (atomic_load_explicit(&r->head, memory_order_acquire) == tail)
+                sched_yield();
+            bench_free(w, r->items[tail & (RING_SIZE - 1)], r->sizes[tail & (RING_SIZE - 1)]);
+            atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+        }
+    }
+    return NULL;
+}
+
+static void* larson_thread(void* arg)
+{
+    struct s_worker* w = arg;
+    size_t per_round = shared.ops / (size_t)shared.threads / LARSON_ROUNDS;
+
+    for (int round = 0; round < LARSON_ROUNDS; round++)
+    {
+        // Cada ronda el hilo trabaja sobre los objetos que dejo otro hilo
+        int set = (w->id + round) % shared.threads;
+        churn(w, shared.slot_sets[set], shared.size_sets[set], LARSON_SLOTS, per_round, pick_medium);
+        pthread_barrier_wait(&shared.barrier);
+    }
+    return NULL;
+}
+
+// Cada ronda el hilo pide sus buffers, los recorre varias veces y los libera.
+// En la ronda siguiente esa memoria la reutiliza otro hilo, que puede correr en
+// otro nodo NUMA: con un heap por nodo sigue siendo memoria local.
+static void* bandwidth_thread(void* arg)
+{
+    struct s_worker* w = arg;
+    void* bufs[BW_BUFFERS];
+    size_t rounds = shared.ops / (size_t)shared.threads / (BW_BUFFERS * (BW_PASSES + 2)) + 1;
+    uint64_t sink = 0;
+
+    for (size_t round = 0; round < rounds; round++)
+    {
+        for (int i = 0; i < BW_BUFFERS; i++)
+            bufs[i] = bench_alloc(w, BW_SIZE);
+        for (int pass = 0; pass < BW_PASSES; pass++)
+        {
+            for (int i = 0; i < BW_BUFFERS; i++)
+            {
+                uint64_t* p = bufs[i];
+                if (!p)
+                    continue;
+                for (size_t k = 0; k < BW_SIZE / sizeof(uint64_t); k++)
+                {
+                    p[k] += k;
+                    sink += p[k];
+                }
+                w->ops++;
+            }
+        }
+        for (int i = 0; i < BW_BUFFERS; i++)
+            bench_free(w, bufs[i], BW_SIZE);
+        pthread_barrier_wait(&shared.barrier);
+    }
+
+    // Evita que el compilador descarte las pasadas
+    w->rng ^= sink;
+    return NULL;
+}
+
+static void run_threads(struct s_worker* w, size_t ops, int threads, void* (*fn)(void*))
+{
+    shared.workers = scratch((size_t)threads * sizeof(struct s_worker));
+    shared.rings = scratch((size_t)(threads / 2 + 1) * sizeof(struct s_ring));
+    shared.slot_sets = scratch((size_t)threads * sizeof(void**));
+    shared.size_sets = scratch((size_t)threads * sizeof(size_t*));
+    shared.ops = ops;
+    shared.threads = threads;
+    pthread_barrier_init(&shared.barrier, NULL, (unsigned)threads);
+
+    pthread_t* tids = scratch((size_t)threads * sizeof(pthread_t));
+    for (int i = 0; i < threads; i++)
+    {
+        shared.slot_sets[i] = scratch(LARSON_SLOTS * sizeof(void*));
+        shared.size_sets[i] = scratch(LARSON_SLOTS * sizeof(size_t));
+        shared.workers[i].a = w->a;
+        shared.workers[i].rng = w->rng + (uint64_t)(unsigned)(i + 1) * 0x9E3779B97F4A7C15ULL;
+        shared.workers[i].id = i;
+    }
+    for (int i = 0; i < threads; i++)
+        pthread_create(&tids[i], NULL, fn, &shared.workers[i]);
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(tids[i], NULL);
+        hist_merge(&w->hist, &shared.workers[i].hist);
+        w->ops += shared.workers[i].ops;
+    }
+    pthread_barrier_destroy(&shared.barrier);
+}
+
+static void run_producer_consumer(struct s_worker* w, size_t ops, int threads)
+{
+    run_threads(w, ops, threads < 2 ? 2 : threads & ~1, producer_consumer_thread);
+}
+
+static void run_larson(struct s_worker* w, size_t ops, int threads)
+{
+    run_threads(w, ops, threads, larson_thread);
+}
+
+static void run_bandwidth(struct s_worker* w, size_t ops, int threads)
+{
+    run_threads(w, ops, threads, bandwidth_thread);
+}
+
+static const struct s_workload workloads[] = {
+    {"uniform_small", 0, run_uniform_small},
+    {"power_law", 0, run_power_law},
+    {"producer_consumer", 1, run_producer_consumer},
+    {"realloc_growth", 0, run_realloc_growth},
+    {"larson", 1, run_larson},
+    {"bandwidth", 1, run_bandwidth},
+};
+
+// Corre la carga en el proceso actual (un hijo) y deja el resultado en res.
+// Los objetos que quedan vivos se liberan al terminar el proceso.
+static void run_child(const struct s_workload* wl, const struct s_allocator* a, size_t ops, int threads,
+                      struct s_result* res)
+{
+    if (a->policy >= 0)
+        malloc_control(a->policy);
+
+    struct s_worker* w = scratch(sizeof(struct s_worker));
+    w->a = a;
+    w->rng = 0x853C49E6748FEA9BULL;
+
+    uint64_t t0 = now_ns();
+    wl->run(w, ops, threads);
+    uint64_t t1 = now_ns();
+
+    res->ops = w->ops;
+    res->seconds = (double)(t1 - t0) / 1e9;
+    res->p50 = hist_percentile(&w->hist, 0.50);
+    res->p99 = hist_percentile(&w->hist, 0.99);
+    res->peak_live = atomic_load(&peak_live);
+    res->fragmentation = NAN;
+    if (a->policy >= 0)
+    {
+        t_mem_stats st;
+        memory_stats(&st);
+        res->fragmentation = st.fragmentation;
+    }
+    res->ok = 1;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t ops = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_OPS;
+    int threads = argc > 2 ? atoi(argv[2]) : BENCH_THREADS;
+    const char* only = argc > 3 ? argv[3] : NULL;
+    if (ops == 0 || threads <= 0)
+    {
+        fprintf(stderr, "Uso: %s [operaciones] [hilos] [carga]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Cada operacion registrada ocupa una pagina: se mide el allocator sin el log
+    set_log_enabled(0);
+
+    // Compartido con los hijos, que escriben ahi su resultado
+    struct s_result* res = mmap(NULL, sizeof(struct s_result), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (res == MAP_FAILED)
+    {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+    printf("workload,allocator,threads,ops,seconds,ops_per_sec,p50_ns,p99_ns,peak_rss_kb,peak_live_kb,fragmentation\n");
+    fflush(stdout);
+
+    for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]); i++)
+    {
+        const struct s_workload* wl = &workloads[i];
+        if (only && strcmp(only, wl->name) != 0)
+            continue;
+
+        for (size_t j = 0; j < sizeof(allocators) / sizeof(allocators[0]); j++)
+        {
+            memset(res, 0, sizeof(*res));
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                perror("fork");
+                return EXIT_FAILURE;
+            }
+            if (pid == 0)
+            {
+                run_child(wl, &allocators[j], ops, threads, res);
+                _exit(EXIT_SUCCESS);
+            }
+
+            int status;
+            struct rusage ru;
+            if (wait4(pid, &status, 0, &ru) < 0 || !res->ok)
+            {
+                fprintf(stderr, "%s/%s: la corrida fallo\n", wl->name, allocators[j].name);
+                continue;
+            }
+
+            printf("%s,%s,%d,%zu,%.6f,%.0f,%lu,%lu,%ld,%zu,%.4f\n", wl->name, allocators[j].name,
+                   wl->threaded ? threads : 1, res->ops, res->seconds, (double)res->ops / res->seconds,
+                   (unsigned long)res->p50, (unsigned long)res->p99, ru.ru_maxrss, res->peak_live / 1024,
+                   res->fragmentation);
+            fflush(stdout);
+        }
+    }
+
+    munmap(res, sizeof(*res));
+    return EXIT_SUCCESS;
+}